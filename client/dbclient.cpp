@@ -593,6 +593,7 @@ namespace mongo {
         // requires that?
         server.reset(new SockAddr(_server.host().c_str(), _server.port()));
         p.reset(new MessagingPort( _so_timeout, _logLevel ));
+        _pendingAcks = 0; // any acknowledgements in flight were lost with the old socket
 
         if (_server.host().empty() || server->getAddr() == "0.0.0.0") {
             stringstream s;
@@ -962,11 +963,57 @@ namespace mongo {
         return port().recv(m);
     }
 
+    MSGID DBClientConnection::sayAcked( Message& toSend, const BSONObj& writeConcern ) {
+        int op = toSend.operation();
+        uassert( 15935, str::stream() << "can only acknowledge inserts, updates and deletes, not " << opToString( op ),
+                 op == dbInsert || op == dbUpdate || op == dbDelete );
+
+        BufBuilder b( toSend.header()->dataLen() + writeConcern.objsize() + 16 );
+        b.appendNum( op );
+        writeConcern.appendSelfToBufBuilder( b );
+        b.appendBuf( toSend.singleData()->_data, toSend.header()->dataLen() );
+
+        Message ack;
+        ack.setData( dbWriteAck, b.buf(), b.len() );
+        say( ack );
+        _pendingAcks++;
+        return ack.header()->id;
+    }
+
+    MSGID DBClientConnection::insertAcked( const string& ns, BSONObj obj, const BSONObj& writeConcern, int flags ) {
+        Message toSend;
+
+        BufBuilder b;
+        b.appendNum( flags );
+        b.appendStr( ns );
+        obj.appendSelfToBufBuilder( b );
+
+        toSend.setData( dbInsert , b.buf() , b.len() );
+
+        return sayAcked( toSend, writeConcern );
+    }
+
+    BSONObj DBClientConnection::recvAck( MSGID *responseTo ) {
+        uassert( 15936, "no acknowledged writes pending", _pendingAcks > 0 );
+        Message response;
+        if ( ! recv( response ) ) {
+            _failed = true;
+            uasserted( 15937, str::stream() << "dbclient error receiving write acknowledgement from: " << getServerAddress() );
+        }
+        _pendingAcks--;
+        if ( responseTo )
+            *responseTo = response.header()->responseTo;
+        QueryResult *qr = (QueryResult *) response.singleData();
+        massert( 15938, "bad write acknowledgement", response.operation() == opReply && qr->nReturned == 1 );
+        return BSONObj( qr->data() ).getOwned();
+    }
+
     bool DBClientConnection::call( Message &toSend, Message &response, bool assertOk , string * actualServer ) {
         /* todo: this is very ugly messagingport::call returns an error code AND can throw
                  an exception.  we should make it return void and just throw an exception anytime
                  it fails
         */
+        uassert( 15939, "call recvAck() for pending acknowledged writes first", _pendingAcks == 0 );
         try {
             if ( !port().call(toSend, response) ) {
                 _failed = true;
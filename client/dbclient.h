@@ -821,7 +821,7 @@ namespace mongo {
            Connect timeout is fixed, but short, at 5 seconds.
          */
         DBClientConnection(bool _autoReconnect=false, DBClientReplicaSet* cp=0, double so_timeout=0) :
-            clientSet(cp), _failed(false), autoReconnect(_autoReconnect), lastReconnectTry(0), _so_timeout(so_timeout) {
+            clientSet(cp), _failed(false), autoReconnect(_autoReconnect), lastReconnectTry(0), _so_timeout(so_timeout), _pendingAcks(0) {
             _numConnections++;
         }
 
@@ -910,6 +910,27 @@ namespace mongo {
 
         string getServerAddress() const { return _serverString; }
 
+        /** Pipelined acknowledged writes.  Sends toSend (a dbInsert, dbUpdate or dbDelete message) wrapped
+            in a dbWriteAck message; the server replies with the getLastError result of that write.  Does not
+            wait for the reply: acknowledgements arrive in send order and are read with recvAck().  Other
+            requests expecting a response can't be made until all pending acknowledgements are received.
+            @param writeConcern getLastError options, e.g. { w : 2 }.  empty for the server defaults.
+            @return the request id the acknowledgement will respond to
+        */
+        MSGID sayAcked( Message& toSend, const BSONObj& writeConcern = BSONObj() );
+
+        /** insert() that is acknowledged, see sayAcked() */
+        MSGID insertAcked( const string& ns, BSONObj obj, const BSONObj& writeConcern = BSONObj(), int flags = 0 );
+
+        /** receive the next acknowledgement for a sayAcked() write.
+            @param responseTo if not null, set to the request id of the acknowledged write
+            @return the getLastError result of that write
+        */
+        BSONObj recvAck( MSGID *responseTo = 0 );
+
+        /** @return # of acknowledged writes sent for which we haven't called recvAck() */
+        unsigned pendingAcks() const { return _pendingAcks; }
+
         virtual void killCursor( long long cursorID );
         virtual bool callRead( Message& toSend , Message& response ) { return call( toSend , response ); }
         virtual void say( Message &toSend, bool isRetry = false );
@@ -949,6 +970,7 @@ namespace mongo {
         map< string, pair<string,string> > authCache;
         double _so_timeout;
         bool _connect( string& errmsg );
+        unsigned _pendingAcks;
 
         static AtomicUInt _numConnections;
         static bool _lazyKillCursor; // lazy means we piggy back kill cursors on next op
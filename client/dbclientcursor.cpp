@@ -99,7 +99,7 @@ namespace mongo {
         return ! retry;
     }
 
-    void DBClientCursor::requestMore() {
+    void DBClientCursor::_assembleGetMore( Message& toSend ) {
         assert( cursorId && b.pos == b.nReturned );
 
         if (haveLimit) {
@@ -112,8 +112,12 @@ namespace mongo {
         b.appendNum(nextBatchSize());
         b.appendNum(cursorId);
 
-        Message toSend;
         toSend.setData(dbGetMore, b.buf(), b.len());
+    }
+
+    void DBClientCursor::requestMore() {
+        Message toSend;
+        _assembleGetMore( toSend );
         auto_ptr<Message> response(new Message());
 
         if ( _client ) {
@@ -133,6 +137,48 @@ namespace mongo {
         }
     }
 
+    void DBClientCursor::requestMoreLazy() {
+        assert( ! _lazyMoreConn );
+        Message toSend;
+        _assembleGetMore( toSend );
+
+        if ( ! _client ) {
+            assert( _scopedHost.size() );
+            _lazyMoreConn = new ScopedDbConnection( _scopedHost );
+        }
+        DBClientBase* conn = _client ? _client : _lazyMoreConn->get();
+        verify( 15951 , conn->lazySupported() );
+        conn->say( toSend );
+    }
+
+    void DBClientCursor::requestMoreLazyFinish() {
+        auto_ptr<Message> response(new Message());
+
+        if ( _client ) {
+            uassert( 15952 , str::stream() << "getMore: no reply from " << _client->getServerAddress() , _client->recv( *response ) );
+            this->b.m = response;
+            dataReceived();
+            return;
+        }
+
+        // a connection we leave without done() is dropped rather than returned to the pool
+        assert( _lazyMoreConn );
+        scoped_ptr<ScopedDbConnection> conn( _lazyMoreConn );
+        _lazyMoreConn = 0;
+        uassert( 15953 , str::stream() << "getMore: no reply from " << _scopedHost , conn->get()->recv( *response ) );
+        _client = conn->get();
+        this->b.m = response;
+        try {
+            dataReceived();
+        }
+        catch ( ... ) {
+            _client = 0;
+            throw;
+        }
+        _client = 0;
+        conn->done();
+    }
+
     /** with QueryOption_Exhaust, the server just blasts data at us (marked at end with cursorid==0). */
     void DBClientCursor::exhaustReceiveMore() {
         assert( cursorId && b.pos == b.nReturned );
@@ -289,6 +335,10 @@ namespace mongo {
 
         DESTRUCTOR_GUARD (
 
+        // a getMore that was sent but never read leaves its reply on the connection
+        delete _lazyMoreConn;
+        _lazyMoreConn = 0;
+
         if ( cursorId && _ownCursor && ! inShutdown() ) {
             BufBuilder b;
             b.appendNum( (int)0 ); // reserved
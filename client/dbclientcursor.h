@@ -26,6 +26,7 @@
 namespace mongo {
 
     class AScopedConnection;
+    class ScopedDbConnection;
 
     /** for mock purposes only -- do not create variants of DBClientCursor, nor hang code here */
     class DBClientCursorInterface {
@@ -135,7 +136,8 @@ namespace mongo {
             batchSize(bs==1?2:bs),
             cursorId(),
             _ownCursor( true ),
-            wasError( false ) {
+            wasError( false ),
+            _lazyMoreConn( 0 ) {
         }
 
         DBClientCursor( DBClientBase* client, const string &_ns, long long _cursorId, int _nToReturn, int options ) :
@@ -145,7 +147,8 @@ namespace mongo {
             haveLimit( _nToReturn > 0 && !(options & QueryOption_CursorTailable)),
             opts( options ),
             cursorId(_cursorId),
-            _ownCursor( true ) {
+            _ownCursor( true ),
+            _lazyMoreConn( 0 ) {
         }
 
         virtual ~DBClientCursor();
@@ -167,6 +170,19 @@ namespace mongo {
         void initLazy( bool isRetry = false );
         bool initLazyFinish( bool& retry );
 
+        /** true if the current batch is used up and only a getMore can tell whether there is more */
+        bool needsGetMore() const {
+            return _putBack.empty() && b.pos >= b.nReturned && cursorId && ! ( haveLimit && b.pos >= nToReturn );
+        }
+
+        /**
+         * getMore in two steps, so a caller holding several cursors can have all their
+         * getMores in flight at once.  only call when needsGetMore() is true, and finish
+         * with requestMoreLazyFinish() before using the cursor again.
+         */
+        void requestMoreLazy();
+        void requestMoreLazyFinish();
+
         class Batch : boost::noncopyable { 
             friend class DBClientCursor;
             auto_ptr<Message> m;
@@ -200,7 +216,9 @@ namespace mongo {
         string _scopedHost;
         string _lazyHost;
         bool wasError;
+        ScopedDbConnection* _lazyMoreConn; // holds the pooled connection between requestMoreLazy() and its finish
 
+        void _assembleGetMore( Message& toSend );
         void dataReceived() { bool retry; string lazyHost; dataReceived( retry, lazyHost ); }
         void dataReceived( bool& retry, string& lazyHost );
         void requestMore();
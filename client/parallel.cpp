@@ -23,6 +23,7 @@
 #include "../db/dbmessage.h"
 #include "../s/util.h"
 #include "../s/shard.h"
+#include "../util/timer.h"
 
 namespace mongo {
 
@@ -275,6 +276,10 @@ namespace mongo {
         return _next;
     }
 
+    bool FilteringClientCursor::needsGetMore() {
+        return _next.isEmpty() && ! _done && _cursor.get() && _cursor->needsGetMore();
+    }
+
     void FilteringClientCursor::_advance() {
         assert( _next.isEmpty() );
         if ( ! _cursor.get() || _done )
@@ -366,6 +371,7 @@ namespace mongo {
     void ParallelSortClusteredCursor::_finishCons() {
         _numServers = _servers.size();
         _cursors = 0;
+        _heapReady = false;
 
         if ( ! _sortKey.isEmpty() && ! _fields.isEmpty() ) {
             // we need to make sure the sort key is in the projection
@@ -421,6 +427,21 @@ namespace mongo {
 
         bool returnPartial = ( _options & QueryOption_PartialResults );
 
+        // a single server's results aren't merged with anything, so it can do the skip
+        // itself.  otherwise each server has to return enough to cover the skip, since we
+        // can't know which of them the skipped documents come from.  a negative batch
+        // size is a limit for the whole query and has to stay negative
+        int nToSkip = 0;
+        if ( _numServers == 1 ) {
+            nToSkip = _needToSkip;
+            _needToSkip = 0;
+        }
+        int batchSize = _batchSize;
+        if ( batchSize > 0 )
+            batchSize += _needToSkip;
+        else if ( batchSize < 0 )
+            batchSize -= _needToSkip;
+
         vector<ServerAndQuery> queries( _servers.begin(), _servers.end() );
         set<int> retryQueries;
         int finishedQueries = 0;
@@ -500,10 +521,10 @@ namespace mongo {
                 if( ! _cursors[i].raw() )
                     _cursors[i].reset( new DBClientCursor( conns[i]->get() , _ns , q ,
                                                             0 , // nToReturn
-                                                            0 , // nToSkip
+                                                            nToSkip , // nToSkip
                                                             _fields.isEmpty() ? 0 : &_fields , // fieldsToReturn
                                                             _options ,
-                                                            _batchSize == 0 ? 0 : _batchSize + _needToSkip // batchSize
+                                                            batchSize // batchSize
                                                             ) );
 
                 try{
@@ -680,6 +701,18 @@ namespace mongo {
             _needToSkip = n;
         }
 
+        if ( ! _sortKey.isEmpty() ) {
+            _initHeap();
+            return ! _heap.empty();
+        }
+
+        for ( int i=0; i<_numServers; i++ ) {
+            if ( ! _cursors[i].needsGetMore() && _cursors[i].more() )
+                return true;
+        }
+
+        _getMores();
+
         for ( int i=0; i<_numServers; i++ ) {
             if ( _cursors[i].more() )
                 return true;
@@ -688,43 +721,120 @@ namespace mongo {
     }
 
     BSONObj ParallelSortClusteredCursor::next() {
-        BSONObj best = BSONObj();
-        int bestFrom = -1;
 
-        for ( int i=0; i<_numServers; i++) {
-            if ( ! _cursors[i].more() )
-                continue;
+        if ( ! _sortKey.isEmpty() ) {
+            _initHeap();
+            uassert( 10019 ,  "no more elements" , ! _heap.empty() );
 
-            BSONObj me = _cursors[i].peek();
+            HeapCompare cmp( this );
+            pop_heap( _heap.begin() , _heap.end() , cmp );
+            int bestFrom = _heap.back();
+            _heap.pop_back();
 
-            if ( best.isEmpty() ) {
-                best = me;
-                bestFrom = i;
-                if( _sortKey.isEmpty() ) break;
-                continue;
+            // only the server we just took from can need a getMore before we know what's next
+            BSONObj best = _cursors[bestFrom].next();
+            if ( _cursors[bestFrom].more() ) {
+                _heap.push_back( bestFrom );
+                push_heap( _heap.begin() , _heap.end() , cmp );
             }
+            return best;
+        }
 
-            int comp = best.woSortOrder( me , _sortKey , true );
-            if ( comp < 0 )
-                continue;
+        // any order will do, so use up what has already arrived before going back to the servers
+        for ( int i=0; i<_numServers; i++ ) {
+            if ( ! _cursors[i].needsGetMore() && _cursors[i].more() )
+                return _cursors[i].next();
+        }
+
+        _getMores();
+
+        for ( int i=0; i<_numServers; i++ ) {
+            if ( _cursors[i].more() )
+                return _cursors[i].next();
+        }
+
+        uasserted( 10019 ,  "no more elements" );
+        return BSONObj();
+    }
 
-            best = me;
-            bestFrom = i;
+    void ParallelSortClusteredCursor::_getMores() {
+        vector<int> sent;
+        for ( int i=0; i<_numServers; i++ ) {
+            if ( ! _cursors[i].needsGetMore() )
+                continue;
+            _cursors[i].raw()->requestMoreLazy();
+            sent.push_back( i );
         }
 
-        uassert( 10019 ,  "no more elements" , ! best.isEmpty() );
-        _cursors[bestFrom].next();
+        for ( unsigned i=0; i<sent.size(); i++ )
+            _cursors[sent[i]].raw()->requestMoreLazyFinish();
+    }
 
-        return best;
+    void ParallelSortClusteredCursor::_initHeap() {
+        if ( _heapReady )
+            return;
+        _heapReady = true;
+
+        _getMores();
+
+        for ( int i=0; i<_numServers; i++ ) {
+            if ( _cursors[i].more() )
+                _heap.push_back( i );
+        }
+        make_heap( _heap.begin() , _heap.end() , HeapCompare( this ) );
     }
 
     void ParallelSortClusteredCursor::_explain( map< string,list<BSONObj> >& out ) {
+        // send every explain before reading any of the replies, so the servers work on
+        // them at the same time.  replies are read in server order, so millisReceived is
+        // exact for the slowest server and an upper bound for the others
+        vector< shared_ptr<ShardConnection> > conns;
+        vector< shared_ptr<DBClientCursor> > cursors;
+        vector<ServerAndQuery> queries;
+
+        Timer t;
         for ( set<ServerAndQuery>::iterator i=_servers.begin(); i!=_servers.end(); ++i ) {
             const ServerAndQuery& sq = *i;
-            list<BSONObj> & l = out[sq._server];
-            l.push_back( explain( sq._server , sq._extra ) );
+
+            shared_ptr<ShardConnection> conn( new ShardConnection( sq._server , _ns ) );
+            if ( ! conn->get()->lazySupported() ) {
+                conn->done();
+                out[sq._server].push_back( explain( sq._server , sq._extra ) );
+                continue;
+            }
+
+            BSONObj q = _query;
+            if ( ! sq._extra.isEmpty() )
+                q = concatQuery( q , sq._extra );
+
+            shared_ptr<DBClientCursor> cursor( new DBClientCursor( conn->get() , _ns , Query( q ).explain().obj ,
+                                                                   abs( _batchSize ) * -1 , 0 ,
+                                                                   _fields.isEmpty() ? 0 : &_fields , 0 , 0 ) );
+            cursor->initLazy();
+
+            conns.push_back( conn );
+            cursors.push_back( cursor );
+            queries.push_back( sq );
         }
 
+        for ( unsigned i=0; i<cursors.size(); i++ ) {
+            const ServerAndQuery& sq = queries[i];
+
+            bool retry = false;
+            if ( ! cursors[i]->initLazyFinish( retry ) ) {
+                conns[i]->done();
+                out[sq._server].push_back( explain( sq._server , sq._extra ) );
+                continue;
+            }
+            long long millis = t.millis();
+            cursors[i]->attach( conns[i].get() ); // this calls done on conn
+
+            BSONObjBuilder b;
+            if ( cursors[i]->more() )
+                b.appendElements( cursors[i]->next() );
+            b.appendNumber( "millisReceived" , millis );
+            out[sq._server].push_back( b.obj() );
+        }
     }
 
     // -----------------
@@ -129,6 +129,9 @@ namespace mongo {
 
         BSONObj peek();
 
+        /** true if more() can't answer without a getMore */
+        bool needsGetMore();
+
         DBClientCursor* raw() { return _cursor.get(); }
 
     private:
@@ -223,7 +226,9 @@ namespace mongo {
 
     /**
      * runs a query in parellel across N servers
-     * sots
+     * with a sort key the results are merged through a heap of the servers' next
+     * documents, otherwise documents are handed out from whichever server has some
+     * buffered.  getMores for every server that ran out go out together.
      */
     class ParallelSortClusteredCursor : public ClusteredCursor {
     public:
@@ -238,6 +243,23 @@ namespace mongo {
         void _finishCons();
         void _init();
 
+        /** sends a getMore to every server whose buffer is used up, then reads all the replies */
+        void _getMores();
+
+        /** puts every server that has a document left in the merge heap, first time only */
+        void _initHeap();
+
+        /** orders _heap so the server with the next document in sort order is on top */
+        class HeapCompare {
+        public:
+            HeapCompare( ParallelSortClusteredCursor* c ) : _c( c ) {}
+            bool operator()( int a , int b ) const {
+                return _c->_cursors[a].peek().woSortOrder( _c->_cursors[b].peek() , _c->_sortKey , true ) > 0;
+            }
+        private:
+            ParallelSortClusteredCursor* _c;
+        };
+
         virtual void _explain( map< string,list<BSONObj> >& out );
 
         int _numServers;
@@ -246,6 +268,9 @@ namespace mongo {
 
         FilteringClientCursor * _cursors;
         int _needToSkip;
+
+        vector<int> _heap; // servers with a document left, when sorting
+        bool _heapReady;
     };
 
     /**
@@ -315,6 +315,9 @@ namespace mongo {
         DEV assert( this == nsdetails(ns) );
         assert( cappedLastDelRecLastExtent().isValid() );
 
+        // the space of the records removed gets reused
+        NamespaceDetailsTransient::get( ns ).oplogStarts().reset();
+
         // We iteratively remove the newest document until the newest document
         // is 'end', then we remove 'end' if requested.
         bool foundLast = false;
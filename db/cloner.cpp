@@ -52,11 +52,14 @@ namespace mongo {
     
     class Cloner: boost::noncopyable {
         auto_ptr< DBClientWithCommands > conn;
+        CloneProgress *_progress;
         void copy(const char *from_ns, const char *to_ns, bool isindex, bool logForRepl,
                   bool masterSameProcess, bool slaveOk, bool mayYield, bool mayBeInterrupted, Query q = Query());
+        void copyCollectionData(const BSONObj& collection, const string& todb, bool logForRepl,
+                                bool masterSameProcess, bool slaveOk, bool snapshot, bool mayYield, bool mayBeInterrupted);
         struct Fun;
     public:
-        Cloner() { }
+        Cloner() : _progress(0) { }
 
         /* slaveOk     - if true it is ok if the source of the data is !ismaster.
            useReplAuth - use the credentials we normally use as a replication slave for the cloning
@@ -69,6 +72,9 @@ namespace mongo {
         bool go(const char *masterHost, string& errmsg, const string& fromdb, bool logForRepl, bool slaveOk, bool useReplAuth, bool snapshot, bool mayYield, bool mayBeInterrupted, int *errCode = 0);
 
         bool copyCollection( const string& ns , const BSONObj& query , string& errmsg , bool mayYield, bool mayBeInterrupted, bool copyIndexes = true, bool logForRepl = true );
+
+        /** copy one collection of a whole database clone, then build its indexes */
+        void cloneCollection( const BSONObj& collection , bool logForRepl , bool slaveOk , bool mayYield , CloneProgress *progress );
     };
 
     /* for index info object:
@@ -120,6 +126,9 @@ namespace mongo {
                 context->relocked();
             }
 
+            int batchDocs = 0;
+            long long batchBytes = 0;
+
             while( i.moreInCurrentBatch() ) {
                 if ( n % 128 == 127 /*yield some*/ ) {
                     time_t now = time(0);
@@ -152,6 +161,8 @@ namespace mongo {
                 }
 
                 ++n;
+                ++batchDocs;
+                batchBytes += tmp.objsize();
 
                 BSONObj js = tmp;
                 if ( isindex ) {
@@ -177,6 +188,9 @@ namespace mongo {
                     saveLast = time( 0 );
                 }
             }
+
+            if ( progress && !isindex )
+                progress->add( batchDocs , batchBytes );
         }
         int n;
         bool isindex;
@@ -188,6 +202,7 @@ namespace mongo {
         Client::Context *context;
         bool _mayYield;
         bool _mayBeInterrupted;
+        CloneProgress *progress;
     };
 
     /* copy the specified collection
@@ -206,6 +221,7 @@ namespace mongo {
         f.logForRepl = logForRepl;
         f._mayYield = mayYield;
         f._mayBeInterrupted = mayBeInterrupted;
+        f.progress = _progress;
 
         int options = QueryOption_NoCursorTimeout | ( slaveOk ? QueryOption_SlaveOk : 0 );
         {
@@ -292,6 +308,66 @@ namespace mongo {
     extern bool inDBRepair;
     void ensureIdIndexForNewNs(const char *ns);
 
+    /** @return true if a database clone copies the collection named from_name */
+    static bool wantToClone( const char *from_name ) {
+        if( strstr(from_name, ".system.") ) {
+            /* system.users and s.js is cloned -- but nothing else from system.
+             * system.indexes is handled specially at the end*/
+            if( legalClientSystemNS( from_name , true ) == 0 ) {
+                log(2) << "\t\t not cloning because system collection" << endl;
+                return false;
+            }
+        }
+        if( ! NamespaceString::normal( from_name ) ) {
+            log(2) << "\t\t not cloning because has $ " << endl;
+            return false;
+        }
+        return true;
+    }
+
+    /* create the collection named in system.namespaces entry 'collection' in todb, copy its
+       documents, then build its _id index in bulk */
+    void Cloner::copyCollectionData(const BSONObj& collection, const string& todb, bool logForRepl,
+                                    bool masterSameProcess, bool slaveOk, bool snapshot, bool mayYield, bool mayBeInterrupted) {
+        log(2) << "  really will clone: " << collection << endl;
+        const char * from_name = collection["name"].valuestr();
+        BSONObj options = collection.getObjectField("options");
+
+        /* change name "<fromdb>.collection" -> <todb>.collection */
+        const char *p = strchr(from_name, '.');
+        assert(p);
+        string to_name = todb + p;
+
+        bool wantIdIndex = false;
+        {
+            string err;
+            const char *toname = to_name.c_str();
+            /* we defer building id index for performance - building it in batch is much faster */
+            userCreateNS(toname, options, err, logForRepl, &wantIdIndex);
+        }
+        log(1) << "\t\t cloning " << from_name << " -> " << to_name << endl;
+        Query q;
+        if( snapshot )
+            q.snapshot();
+        copy(from_name, to_name.c_str(), false, logForRepl, masterSameProcess, slaveOk, mayYield, mayBeInterrupted, q);
+
+        if( wantIdIndex ) {
+            /* we need dropDups to be true as we didn't do a true snapshot and this is before applying oplog operations
+               that occur during the initial sync.  inDBRepair makes dropDups be true.
+               */
+            bool old = inDBRepair;
+            try {
+                inDBRepair = true;
+                ensureIdIndexForNewNs(to_name.c_str());
+                inDBRepair = old;
+            }
+            catch(...) {
+                inDBRepair = old;
+                throw;
+            }
+        }
+    }
+
     bool Cloner::go(const char *masterHost, string& errmsg, const string& fromdb, bool logForRepl, bool slaveOk, bool useReplAuth, bool snapshot, bool mayYield, bool mayBeInterrupted, int *errCode) {
         if ( errCode ) {
             *errCode = 0;
@@ -376,20 +452,8 @@ namespace mongo {
                 }
                 assert( !e.eoo() );
                 assert( e.type() == String );
-                const char *from_name = e.valuestr();
-
-                if( strstr(from_name, ".system.") ) {
-                    /* system.users and s.js is cloned -- but nothing else from system.
-                     * system.indexes is handled specially at the end*/
-                    if( legalClientSystemNS( from_name , true ) == 0 ) {
-                        log(2) << "\t\t not cloning because system collection" << endl;
-                        continue;
-                    }
-                }
-                if( ! NamespaceString::normal( from_name ) ) {
-                    log(2) << "\t\t not cloning because has $ " << endl;
+                if( ! wantToClone( e.valuestr() ) )
                     continue;
-                }
                 toClone.push_back( collection.getOwned() );
             }
         }
@@ -399,44 +463,7 @@ namespace mongo {
                 mayInterrupt( mayBeInterrupted );
                 dbtempreleaseif r( mayYield );
             }
-            BSONObj collection = *i;
-            log(2) << "  really will clone: " << collection << endl;
-            const char * from_name = collection["name"].valuestr();
-            BSONObj options = collection.getObjectField("options");
-
-            /* change name "<fromdb>.collection" -> <todb>.collection */
-            const char *p = strchr(from_name, '.');
-            assert(p);
-            string to_name = todb + p;
-
-            bool wantIdIndex = false;
-            {
-                string err;
-                const char *toname = to_name.c_str();
-                /* we defer building id index for performance - building it in batch is much faster */
-                userCreateNS(toname, options, err, logForRepl, &wantIdIndex);
-            }
-            log(1) << "\t\t cloning " << from_name << " -> " << to_name << endl;
-            Query q;
-            if( snapshot )
-                q.snapshot();
-            copy(from_name, to_name.c_str(), false, logForRepl, masterSameProcess, slaveOk, mayYield, mayBeInterrupted, q);
-
-            if( wantIdIndex ) {
-                /* we need dropDups to be true as we didn't do a true snapshot and this is before applying oplog operations
-                   that occur during the initial sync.  inDBRepair makes dropDups be true.
-                   */
-                bool old = inDBRepair;
-                try {
-                    inDBRepair = true;
-                    ensureIdIndexForNewNs(to_name.c_str());
-                    inDBRepair = old;
-                }
-                catch(...) {
-                    inDBRepair = old;
-                    throw;
-                }
-            }
+            copyCollectionData( *i , todb , logForRepl , masterSameProcess , slaveOk , snapshot , mayYield , mayBeInterrupted );
         }
 
         // now build the indexes
@@ -459,6 +486,122 @@ namespace mongo {
         return c.go(masterHost, errmsg, fromdb, logForReplication, slaveOk, useReplAuth, snapshot, mayYield, mayBeInterrupted, errCode);
     }
 
+    void Cloner::cloneCollection( const BSONObj& collection , bool logForRepl , bool slaveOk , bool mayYield , CloneProgress *progress ) {
+        string todb = cc().database()->name;
+        const char *from_name = collection["name"].valuestr();
+        const char *p = strchr( from_name , '.' );
+        assert( p );
+        string fromdb( from_name , p - from_name );
+
+        _progress = progress;
+        copyCollectionData( collection , todb , logForRepl , /*masterSameProcess*/false , slaveOk , /*snapshot*/false , mayYield , /*mayBeInterrupted*/false );
+        _progress = 0;
+
+        if ( progress )
+            progress->indexing();
+
+        // the collection is full, so these are bulk builds too
+        string system_indexes_from = fromdb + ".system.indexes";
+        string system_indexes_to = todb + ".system.indexes";
+        copy( system_indexes_from.c_str() , system_indexes_to.c_str() , true , logForRepl , false , slaveOk , mayYield , false ,
+              BSON( "ns" << from_name << "name" << NE << "_id_" ) );
+    }
+
+    bool collectionsToClone( DBClientBase *conn , const string& fromdb , bool slaveOk , list<BSONObj>& collections , string& errmsg ) {
+        string ns = fromdb + ".system.namespaces";
+        auto_ptr<DBClientCursor> c = conn->query( ns.c_str() , BSONObj() , 0 , 0 , 0 , slaveOk ? QueryOption_SlaveOk : 0 );
+        if ( c.get() == 0 ) {
+            errmsg = "query failed " + ns;
+            return false;
+        }
+        while ( c->more() ) {
+            BSONObj collection = c->nextSafe();
+            BSONElement e = collection.getField( "name" );
+            massert( 15947 , "bad system.namespaces object " + collection.toString() , e.type() == String );
+            if ( wantToClone( e.valuestr() ) )
+                collections.push_back( collection.getOwned() );
+        }
+        return true;
+    }
+
+    bool cloneCollectionFrom( const string& host , const BSONObj& collection , bool logForReplication , bool slaveOk ,
+                              bool mayYield , CloneProgress *progress , string& errmsg ) {
+        Cloner c;
+
+        DBClientConnection *conn = new DBClientConnection();
+        // cloner owns conn in auto_ptr
+        c.setConnection( conn );
+        {
+            dbtempreleaseif r( mayYield );
+            if ( ! conn->connect( host , errmsg ) || ! replAuthenticate( conn ) ) {
+                if ( errmsg.empty() )
+                    errmsg = "couldn't authenticate to " + host;
+                return false;
+            }
+        }
+
+        c.cloneCollection( collection , logForReplication , slaveOk , mayYield , progress );
+        getDur().commitIfNeeded();
+        return true;
+    }
+
+    CloneProgress::CloneProgress( const string& ns ) :
+        _ns( ns ), _m( "CloneProgress" ), _state( "pending" ), _docs( 0 ), _bytes( 0 ), _started( 0 ), _finished( 0 ) {
+    }
+
+    void CloneProgress::start() {
+        scoped_lock lk( _m );
+        _state = "cloning";
+        _started = curTimeMillis64();
+    }
+
+    void CloneProgress::add( long long docs , long long bytes ) {
+        scoped_lock lk( _m );
+        _docs += docs;
+        _bytes += bytes;
+    }
+
+    void CloneProgress::indexing() {
+        scoped_lock lk( _m );
+        _state = "indexing";
+    }
+
+    void CloneProgress::finish( bool ok ) {
+        scoped_lock lk( _m );
+        _state = ok ? "done" : "failed";
+        _finished = curTimeMillis64();
+    }
+
+    bool CloneProgress::finished() const {
+        scoped_lock lk( _m );
+        return _finished != 0;
+    }
+
+    long long CloneProgress::docs() const {
+        scoped_lock lk( _m );
+        return _docs;
+    }
+
+    long long CloneProgress::bytes() const {
+        scoped_lock lk( _m );
+        return _bytes;
+    }
+
+    void CloneProgress::append( BSONObjBuilder& b ) const {
+        scoped_lock lk( _m );
+        b.append( "ns" , _ns );
+        b.append( "state" , _state );
+        b.appendNumber( "docs" , _docs );
+        b.appendNumber( "bytes" , _bytes );
+        if ( _started ) {
+            long long millis = ( _finished ? _finished : curTimeMillis64() ) - _started;
+            b.appendNumber( "millis" , millis );
+            double secs = millis ? millis / 1000.0 : 0.001;
+            b.append( "docsPerSec" , _docs / secs );
+            b.append( "MBPerSec" , _bytes / secs / ( 1024 * 1024 ) );
+        }
+    }
+
     /* Usage:
        mydb.$cmd.findOne( { clone: "fromhost" } );
     */
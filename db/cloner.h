@@ -21,7 +21,9 @@
 #include "jsobj.h"
 
 namespace mongo {
-    
+
+    class DBClientBase;
+
     /**
      * @param slaveOk     - if true it is ok if the source of the data is !ismaster.
      * @param useReplAuth - use the credentials we normally use as a replication slave for the cloning
@@ -36,4 +38,46 @@ namespace mongo {
 
     bool copyCollectionFromRemote(const string& host, const string& ns, string& errmsg);
 
+    /**
+     * progress of cloning one collection: written by the thread cloning it,
+     * readable from any thread.
+     */
+    class CloneProgress : boost::noncopyable {
+    public:
+        CloneProgress(const string& ns);
+        const string& ns() const { return _ns; }
+        void start();
+        void add(long long docs, long long bytes);
+        void indexing();
+        void finish(bool ok);
+        bool finished() const;
+        long long docs() const;
+        long long bytes() const;
+        /** { ns, state, docs, bytes, millis, docsPerSec, MBPerSec } */
+        void append(BSONObjBuilder& b) const;
+    private:
+        const string _ns;
+        mutable mongo::mutex _m;
+        const char *_state;
+        long long _docs;
+        long long _bytes;
+        unsigned long long _started;
+        unsigned long long _finished;
+    };
+
+    /**
+     * lists the collections of fromdb a database clone copies, as their system.namespaces entries
+     */
+    bool collectionsToClone(DBClientBase *conn, const string& fromdb, bool slaveOk, list<BSONObj>& collections, string& errmsg);
+
+    /**
+     * clones one collection of the current database from host, over a connection of its
+     * own, the way cloneFrom clones each collection: the documents are copied first, then
+     * the _id index and the other indexes are built in bulk.
+     * @param collection the collection's system.namespaces entry on host
+     * @param progress   if not null, updated as documents arrive
+     */
+    bool cloneCollectionFrom(const string& host, const BSONObj& collection, bool logForReplication, bool slaveOk,
+                             bool mayYield, CloneProgress *progress, string& errmsg);
+
 } // namespace mongo
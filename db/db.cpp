@@ -44,6 +44,7 @@
 #include "dur.h"
 #include "concurrency.h"
 #include "../s/d_writeback.h"
+#include "ttl.h"
 
 #if defined(_WIN32)
 # include "../util/ntservice.h"
@@ -501,6 +502,7 @@ namespace mongo {
         snapshotThread.go();
         clientCursorMonitor.go();
         PeriodicTask::theRunner->go();
+        startTTLBackgroundJob();
         
 #ifndef _WIN32
         CmdLine::launchOk();
@@ -48,6 +48,7 @@
 #include "../util/version.h"
 #include "../s/d_writeback.h"
 #include "dur_stats.h"
+#include "ttl.h"
 
 namespace mongo {
 
@@ -198,6 +199,9 @@ namespace mongo {
                         break;
                     }
 
+                    // read before checking, so a slave catching up in between still wakes us
+                    unsigned long long progress = slaveProgressGeneration();
+
                     // check this first for w=0 or w=1
                     if ( opReplicatedEnough( op, e ) ) {
                         break;
@@ -211,6 +215,7 @@ namespace mongo {
 
 
                     if ( timeout > 0 && t.millis() >= timeout ) {
+                        noteWriteConcernWait( e , t.millis() , true );
                         result.append( "wtimeout" , true );
                         errmsg = "timed out waiting for slaves";
                         result.append( "waited" , t.millis() );
@@ -220,9 +225,18 @@ namespace mongo {
 
                     assert( sprintf( buf , "w block pass: %lld" , ++passes ) < 30 );
                     c.curop()->setMessage( buf );
-                    sleepmillis(1);
+
+                    // woken as soon as a slave reports progress; the cap keeps us checking
+                    // for interruption, timeouts and stepdowns
+                    int wait = 100;
+                    if ( timeout > 0 )
+                        wait = min( wait , timeout - t.millis() );
+                    if ( wait > 0 )
+                        awaitSlaveProgress( progress , wait );
                     killCurrentOp.checkForInterrupt();
                 }
+                if ( ! c.getLastOp().isNull() )
+                    noteWriteConcernWait( e , t.millis() , false );
                 result.appendNumber( "wtime" , t.millis() );
             }
 
@@ -551,6 +565,12 @@ namespace mongo {
                 bb.done();
             }
 
+            {
+                BSONObjBuilder bb( result.subobjStart( "ttl" ) );
+                appendTTLStats( bb );
+                bb.done();
+            }
+
             {
                 BSONObjBuilder bb( result.subobjStart( "network" ) );
                 networkCounter.append( bb );
@@ -565,6 +585,10 @@ namespace mongo {
                 appendReplicationInfo( bb , authed , cmdObj["repl"].numberInt() );
                 bb.done();
 
+                BSONObjBuilder wb( result.subobjStart( "writeConcern" ) );
+                appendWriteConcernStats( wb );
+                wb.done();
+
                 if ( ! _isMaster() ) {
                     result.append( "opcountersRepl" , replOpCounters.getObj() );
                 }
@@ -1341,6 +1365,11 @@ namespace mongo {
             result.append( "nindexes" , nsd->nIndexes );
             result.append( "lastExtentSize" , nsd->lastExtentSize / scale );
             result.append( "paddingFactor" , nsd->paddingFactor );
+            {
+                BSONObjBuilder growth( result.subobjStart( "recordGrowth" ) );
+                NamespaceDetailsTransient::get( ns.c_str() ).growthStats().appendStats( growth );
+                growth.done();
+            }
             result.append( "flags" , nsd->flags );
 
             BSONObjBuilder indexSizes;
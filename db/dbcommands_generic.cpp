@@ -124,6 +124,18 @@ namespace mongo {
         */
     unsigned replApplyBatchSize = 1;
 
+    /** see IndexUpdateBatch.  0 means index changes of multi updates are applied per document. */
+    unsigned multiUpdateIndexBatchSize = 0;
+
+    /** threads touching the records and index keys of replicated ops before a replica set secondary applies them. 0 disables. */
+    unsigned replPrefetchThreads = 4;
+
+    /** collections a replica set member clones at once during initial sync. */
+    unsigned replInitialSyncCloneThreads = 4;
+
+    /** a replica set member syncs from the closest member no more than this far behind the freshest one. */
+    unsigned replMaxSyncSourceLagSecs = 30;
+
     class CmdGet : public Command {
     public:
         CmdGet() : Command( "getParameter" ) { }
@@ -160,6 +172,18 @@ namespace mongo {
             if( all || cmdObj.hasElement("replApplyBatchSize") ) {
                 result.append("replApplyBatchSize", replApplyBatchSize);
             }
+            if( all || cmdObj.hasElement("multiUpdateIndexBatchSize") ) {
+                result.append("multiUpdateIndexBatchSize", multiUpdateIndexBatchSize);
+            }
+            if( all || cmdObj.hasElement("replPrefetchThreads") ) {
+                result.append("replPrefetchThreads", replPrefetchThreads);
+            }
+            if( all || cmdObj.hasElement("replInitialSyncCloneThreads") ) {
+                result.append("replInitialSyncCloneThreads", replInitialSyncCloneThreads);
+            }
+            if( all || cmdObj.hasElement("replMaxSyncSourceLagSecs") ) {
+                result.append("replMaxSyncSourceLagSecs", replMaxSyncSourceLagSecs);
+            }
 
             if ( before == result.len() ) {
                 errmsg = "no option found to get";
@@ -184,6 +208,10 @@ namespace mongo {
             help << "supported so far:\n";
             help << "  journalCommitInterval\n";
             help << "  logLevel\n";
+            help << "  multiUpdateIndexBatchSize\n";
+            help << "  replPrefetchThreads\n";
+            help << "  replInitialSyncCloneThreads\n";
+            help << "  replMaxSyncSourceLagSecs\n";
             help << "  notablescan\n";
             help << "  quiet\n";
             help << "  syncdelay\n";
@@ -239,6 +267,50 @@ namespace mongo {
                 replApplyBatchSize = e.numberInt();
                 s++;
             }
+            if( cmdObj.hasElement( "multiUpdateIndexBatchSize" ) ) {
+                if( s == 0 )
+                    result.append("was", multiUpdateIndexBatchSize );
+                BSONElement e = cmdObj["multiUpdateIndexBatchSize"];
+                ParameterValidator * v = ParameterValidator::get( e.fieldName() );
+                assert( v );
+                if ( ! v->isValid( e , errmsg ) )
+                    return false;
+                multiUpdateIndexBatchSize = e.numberInt();
+                s++;
+            }
+            if( cmdObj.hasElement( "replPrefetchThreads" ) ) {
+                if( s == 0 )
+                    result.append("was", replPrefetchThreads );
+                BSONElement e = cmdObj["replPrefetchThreads"];
+                ParameterValidator * v = ParameterValidator::get( e.fieldName() );
+                assert( v );
+                if ( ! v->isValid( e , errmsg ) )
+                    return false;
+                replPrefetchThreads = e.numberInt();
+                s++;
+            }
+            if( cmdObj.hasElement( "replInitialSyncCloneThreads" ) ) {
+                if( s == 0 )
+                    result.append("was", replInitialSyncCloneThreads );
+                BSONElement e = cmdObj["replInitialSyncCloneThreads"];
+                ParameterValidator * v = ParameterValidator::get( e.fieldName() );
+                assert( v );
+                if ( ! v->isValid( e , errmsg ) )
+                    return false;
+                replInitialSyncCloneThreads = e.numberInt();
+                s++;
+            }
+            if( cmdObj.hasElement( "replMaxSyncSourceLagSecs" ) ) {
+                if( s == 0 )
+                    result.append("was", replMaxSyncSourceLagSecs );
+                BSONElement e = cmdObj["replMaxSyncSourceLagSecs"];
+                ParameterValidator * v = ParameterValidator::get( e.fieldName() );
+                assert( v );
+                if ( ! v->isValid( e , errmsg ) )
+                    return false;
+                replMaxSyncSourceLagSecs = e.numberInt();
+                s++;
+            }
 
             if( s == 0 && !found ) {
                 errmsg = "no option found to set, use help:true to see options ";
@@ -237,7 +237,7 @@ namespace mongo {
         return me.obj();
     }
 
-    long long Helpers::removeRange( const string& ns , const BSONObj& min , const BSONObj& max , bool yield , bool maxInclusive , RemoveCallback * callback ) {
+    long long Helpers::removeRange( const string& ns , const BSONObj& min , const BSONObj& max , bool yield , bool maxInclusive , RemoveCallback * callback , const BSONObj& keyPattern ) {
         BSONObj keya , keyb;
         BSONObj minClean = toKeyFormat( min , keya );
         BSONObj maxClean = toKeyFormat( max , keyb );
@@ -248,7 +248,7 @@ namespace mongo {
         if ( ! nsd )
             return 0;
 
-        int ii = nsd->findIndexByKeyPattern( keya );
+        int ii = nsd->findIndexByKeyPattern( keyPattern.isEmpty() ? keya : keyPattern );
         assert( ii >= 0 );
 
         long long num = 0;
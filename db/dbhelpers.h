@@ -109,8 +109,9 @@ namespace mongo {
             virtual ~RemoveCallback() {}
             virtual void goingToDelete( const BSONObj& o ) = 0;
         };
-        /* removeRange: operation is oplog'd */
-        static long long removeRange( const string& ns , const BSONObj& min , const BSONObj& max , bool yield = false , bool maxInclusive = false , RemoveCallback * callback = 0 );
+        /* removeRange: operation is oplog'd
+           keyPattern: the index to scan, by default the ascending one over min's fields */
+        static long long removeRange( const string& ns , const BSONObj& min , const BSONObj& max , bool yield = false , bool maxInclusive = false , RemoveCallback * callback = 0 , const BSONObj& keyPattern = BSONObj() );
 
         /* Remove all objects from a collection.
         You do not need to set the database before calling.
@@ -73,6 +73,12 @@ namespace mongo {
    dbKillCursors=2007:
       int n;
       int64 cursorIDs[n];
+   dbWriteAck=2008:
+      int writeOp;          // dbInsert, dbUpdate or dbDelete
+      JSObject writeConcern; // getLastError options, e.g. { w : 2 }.  {} for the defaults
+      ...                   // the body of writeOp, as if sent on its own (starting with its int options)
+      the reply is a QueryResult with one object, the getLastError result for the write, and
+      responseTo set to the id of the request.  lets a client pipeline acknowledged writes.
 
    Note that on Update, there is only one object, which is different
    from insert where you can pass a list of objects to insert in the db.
@@ -0,0 +1,93 @@
+// hasher.cpp
+
+/**
+*    Copyright (C) 2011 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "pch.h"
+#include "hasher.h"
+#include "../util/md5.hpp"
+
+namespace mongo {
+
+    namespace {
+
+        void append( md5_state_t& st , const void* data , int len ) {
+            md5_append( &st , (const md5_byte_t*)data , len );
+        }
+
+        void appendElement( md5_state_t& st , const BSONElement& e , bool includeFieldName ) {
+            int canonicalType = e.canonicalType();
+            append( st , &canonicalType , sizeof( canonicalType ) );
+
+            if ( includeFieldName )
+                append( st , e.fieldName() , strlen( e.fieldName() ) + 1 );
+
+            switch ( e.type() ) {
+            case MinKey:
+            case MaxKey:
+            case EOO:
+            case Undefined:
+            case jstNULL:
+                break;
+
+            case NumberInt:
+            case NumberLong:
+            case NumberDouble: {
+                double d = e.numberDouble();
+                if ( d == 0 )
+                    d = 0; // -0.0 == 0.0
+                append( st , &d , sizeof( d ) );
+                break;
+            }
+
+            case String:
+            case Symbol:
+            case Code:
+                append( st , e.valuestr() , e.valuestrsize() );
+                break;
+
+            case Object:
+            case Array: {
+                BSONObjIterator i( e.embeddedObject() );
+                while ( i.more() )
+                    appendElement( st , i.next() , true );
+                break;
+            }
+
+            default:
+                // fixed layout types: compare equal only when bytewise identical
+                append( st , e.value() , e.valuesize() );
+                break;
+            }
+        }
+
+    }
+
+    long long BSONElementHasher::hash64( const BSONElement& e , int seed ) {
+        md5_state_t st;
+        md5_init( &st );
+        append( st , &seed , sizeof( seed ) );
+        appendElement( st , e , false );
+
+        md5digest d;
+        md5_finish( &st , d );
+
+        long long h;
+        memcpy( &h , d , sizeof( h ) );
+        return h;
+    }
+
+}
@@ -0,0 +1,43 @@
+// hasher.h
+
+/**
+*    Copyright (C) 2011 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "jsobj.h"
+
+namespace mongo {
+
+    /**
+     * 64 bit hash of a BSON value, used by hashed indexes.
+     *
+     * Values which compare equal hash equally: all numeric types are hashed as
+     * their double value (so 1, 1.0 and NumberLong(1) collide on purpose) and
+     * objects/arrays are hashed recursively by field name and value.  The field
+     * name of the element itself is not part of the hash.
+     *
+     * The result is persisted in index keys, so the algorithm must never change
+     * for a given seed.
+     */
+    class BSONElementHasher : boost::noncopyable {
+    public:
+        static const int DEFAULT_HASH_SEED = 0;
+
+        static long long hash64( const BSONElement& e , int seed = DEFAULT_HASH_SEED );
+    };
+
+}
@@ -0,0 +1,154 @@
+// hashindex.cpp
+
+/**
+*    Copyright (C) 2011 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "pch.h"
+#include "namespace-inl.h"
+#include "jsobj.h"
+#include "index.h"
+#include "btree.h"
+#include "queryutil.h"
+#include "cursor.h"
+#include "hasher.h"
+
+/**
+ * hashed index: { a : "hashed" }
+ *
+ * each document gets the single key { "" : NumberLong( hash(a) ) }, so the
+ * btree stays compact and evenly filled no matter how large or how skewed the
+ * values of a are.  only equality and $in can use the index - the hash order has
+ * nothing to do with the value order - and since hashes may collide every
+ * candidate document is re-checked by the full matcher.
+ */
+namespace mongo {
+
+    const string HASHEDNAME = "hashed";
+
+    class HashedIndexType : public IndexType {
+    public:
+        HashedIndexType( const IndexPlugin* plugin , const IndexSpec* spec )
+            : IndexType( plugin , spec ) {
+
+            BSONObjIterator i( spec->keyPattern );
+            _field = i.next().fieldName();
+            uassert( 15941 , "hashed indexes can only have a single field" , ! i.more() );
+            uassert( 15942 , "hashed indexes can't be unique" , ! spec->info["unique"].trueValue() );
+            _sparse = spec->info["sparse"].trueValue();
+        }
+
+        void getKeys( const BSONObj &obj, BSONObjSet &keys ) const {
+            // a path may go through an array, { a : [ { b : 1 } ] } for "a.b", as long as it
+            // ends up at a single value
+            BSONElementSet fields;
+            obj.getFieldsDotted( _field , fields , false );
+            uassert( 15956 , str::stream() << "hashed field has more than one value: " << _field , fields.size() <= 1 );
+
+            BSONElement e;
+            if ( fields.empty() ) {
+                if ( _sparse )
+                    return;
+                e = _spec->missingField();
+            }
+            else {
+                e = *fields.begin();
+            }
+            uassert( 15943 , str::stream() << "can't index array in hashed field: " << _field , e.type() != Array );
+            keys.insert( BSON( "" << BSONElementHasher::hash64( e ) ) );
+        }
+
+        /**
+         * HELPFUL for { a : v } and { a : { $in : [ ... ] } } without regular
+         * expressions, USELESS for everything else (ranges, $ne, $exists, ...)
+         */
+        IndexSuitability suitability( const BSONObj& query , const BSONObj& order ) const {
+            BSONElement e = query.getFieldDotted( _field );
+            switch ( e.type() ) {
+            case EOO:
+            case RegEx:
+                return USELESS;
+            case Object: {
+                BSONElement op = e.embeddedObject().firstElement();
+                if ( op.eoo() || op.fieldName()[0] != '$' )
+                    return HELPFUL; // equality with an embedded object
+                if ( op.getGtLtOp() != BSONObj::opIN || op.type() != Array || e.embeddedObject().nFields() != 1 )
+                    return USELESS;
+                BSONObjIterator i( op.embeddedObject() );
+                while ( i.more() ) {
+                    BSONType t = i.next().type();
+                    if ( t == RegEx || t == Array )
+                        return USELESS;
+                }
+                return HELPFUL;
+            }
+            case Array:
+                // no array is ever indexed, so no document can match - the
+                // index answers this with an empty scan
+                return HELPFUL;
+            default:
+                return HELPFUL;
+            }
+        }
+
+        shared_ptr<Cursor> newCursor( const BSONObj& query , const BSONObj& order , int numWanted ) const {
+            BSONArrayBuilder hashes;
+            BSONElement e = query.getFieldDotted( _field );
+            if ( e.type() == Object && e.embeddedObject().firstElement().getGtLtOp() == BSONObj::opIN ) {
+                BSONObjIterator i( e.embeddedObject().firstElement().embeddedObject() );
+                while ( i.more() )
+                    hashes.append( BSONElementHasher::hash64( i.next() ) );
+            }
+            else if ( e.type() != Array ) {
+                hashes.append( BSONElementHasher::hash64( e ) );
+            }
+
+            BSONArray arr = hashes.arr();
+            if ( arr.isEmpty() ) {
+                // nothing can match, same dummy cursor QueryPlan uses for impossible queries
+                return shared_ptr<Cursor>( new BasicCursor( DiskLoc() ) );
+            }
+
+            const IndexDetails *details = _spec->getDetails();
+            massert( 15944 , "hashed index spec has no index" , details );
+            string ns = details->parentNS();
+            NamespaceDetails *d = nsdetails( ns.c_str() );
+            int idxNo = d->idxNo( const_cast<IndexDetails&>( *details ) );
+
+            FieldRangeSet frs( ns.c_str() , BSON( _field << BSON( "$in" << arr ) ) , true );
+            shared_ptr<FieldRangeVector> frv( new FieldRangeVector( frs , *_spec , 1 ) );
+            return shared_ptr<Cursor>( BtreeCursor::make( d , idxNo , *details , frv , 1 ) );
+        }
+
+    private:
+        string _field;
+        bool _sparse;
+    };
+
+    class HashedIndexPlugin : public IndexPlugin {
+    public:
+        HashedIndexPlugin() : IndexPlugin( HASHEDNAME ) {
+        }
+
+        virtual IndexType* generate( const IndexSpec* spec ) const {
+            return new HashedIndexType( this , spec );
+        }
+    } hashedIndexPlugin;
+
+    void __forceLinkHashedPlugin() {
+        hashedIndexPlugin.getName();
+    }
+
+}
@@ -280,6 +280,76 @@ namespace mongo {
         }
     }
 
+    void IndexUpdateBatch::_add(int idxNo, const BSONObj& key, const DiskLoc& loc, bool add) {
+        Change c;
+        c.key = key.getOwned();
+        c.loc = loc;
+        c.add = add;
+        _changes[idxNo].push_back(c);
+        _n++;
+    }
+
+    namespace {
+        class ChangeOrder {
+        public:
+            ChangeOrder(const Ordering& o) : _o(o) { }
+            template< class C >
+            bool operator()(const C& l, const C& r) const {
+                if( l.add != r.add )
+                    return !l.add; // removals first
+                int x = l.key.woCompare(r.key, _o, false);
+                if( x )
+                    return x < 0;
+                return l.loc < r.loc;
+            }
+        private:
+            const Ordering& _o;
+        };
+    }
+
+    unsigned IndexUpdateBatch::flush() {
+        if( _n == 0 )
+            return 0;
+        unsigned applied = 0;
+        NamespaceDetails *d = nsdetails(_ns.c_str());
+        massert( 15930, str::stream() << "ns dropped during batched index update: " << _ns, d );
+        for( map< int, vector<Change> >::iterator i = _changes.begin(); i != _changes.end(); ++i ) {
+            IndexDetails& idx = d->idx(i->first);
+            IndexInterface& ii = idx.idxInterface();
+            const Ordering ordering = Ordering::make(idx.keyPattern());
+            vector<Change>& v = i->second;
+            sort(v.begin(), v.end(), ChangeOrder(ordering));
+            for( vector<Change>::iterator j = v.begin(); j != v.end(); ++j ) {
+                try {
+                    if( j->add ) {
+                        ii.bt_insert(idx.head, j->loc, j->key, ordering, /*dupsAllowed*/true, idx);
+                    }
+                    else if( !ii.unindex(idx.head, idx, j->key, j->loc) ) {
+                        RARELY warning() << "ns: " << _ns << " couldn't unindex key: " << j->key << endl;
+                    }
+                    applied++;
+                }
+                catch( AssertionException& e ) {
+                    problem() << " caught assertion batched index update " << idx.indexNamespace() << " " << e << endl;
+                }
+            }
+        }
+        _changes.clear();
+        _n = 0;
+        return applied;
+    }
+
+    IndexUpdateBatch::~IndexUpdateBatch() {
+        if( _n == 0 )
+            return;
+        try {
+            flush();
+        }
+        catch( DBException& e ) {
+            problem() << "couldn't apply batched index changes for " << _ns << ' ' << e.toString() << endl;
+        }
+    }
+
     // should be { <something> : <simpletype[1|-1]>, .keyp.. }
     static bool validKeyPattern(BSONObj kp) {
         BSONObjIterator i(kp);
@@ -332,6 +402,13 @@ namespace mongo {
             uasserted(12504, s);
         }
 
+        if ( io.hasField( "expireAfterSeconds" ) ) {
+            BSONElement e = io["expireAfterSeconds"];
+            uassert( 15945 , "expireAfterSeconds must be a non negative number" , e.isNumber() && e.number() >= 0 );
+            uassert( 15946 , "TTL indexes must be on a single ascending field" ,
+                     key.nFields() == 1 && key.firstElement().isNumber() && key.firstElement().number() > 0 );
+        }
+
         sourceCollection = nsdetails(sourceNS.c_str());
         if( sourceCollection == 0 ) {
             // try to create it
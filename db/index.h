@@ -231,6 +231,44 @@ namespace mongo {
     };
 
     class NamespaceDetails;
+
+    /* Index key changes of a multi document update, deferred so they can be applied in key order.
+       Updating documents one by one in scan order touches each index in random key order; for large
+       multi updates of indexed fields that means a random btree page access per key.  We collect the
+       removed/added keys of several documents and apply them per index, sorted.
+
+       Only non unique indexes are deferred: dupCheck() on a unique index has to see the keys of the
+       documents updated before.  Pending changes must be flushed before the write lock is yielded.
+    */
+    class IndexUpdateBatch : boost::noncopyable {
+    public:
+        IndexUpdateBatch(const char *ns, unsigned maxKeys) : _ns(ns), _maxKeys(maxKeys), _n(0) { }
+        ~IndexUpdateBatch();
+
+        /* @return true if changes to idx may be deferred. */
+        static bool canDefer(const IndexDetails& idx) { return !idx.unique(); }
+
+        void remove(int idxNo, const BSONObj& key, const DiskLoc& loc) { _add(idxNo, key, loc, false); }
+        void add(int idxNo, const BSONObj& key, const DiskLoc& loc) { _add(idxNo, key, loc, true); }
+
+        bool empty() const { return _n == 0; }
+        bool full() const { return _n >= _maxKeys; }
+
+        /* apply the pending changes to the btrees.  @return number of keys applied. */
+        unsigned flush();
+    private:
+        struct Change {
+            BSONObj key;
+            DiskLoc loc;
+            bool add;
+        };
+        void _add(int idxNo, const BSONObj& key, const DiskLoc& loc, bool add);
+        const string _ns;
+        const unsigned _maxKeys;
+        unsigned _n;
+        map< int, vector<Change> > _changes; // idxNo -> changes
+    };
+
     // changedId should be initialized to false
     void getIndexChanges(vector<IndexChanges>& v, NamespaceDetails& d, BSONObj newObj, BSONObj oldObj, bool &cangedId);
     void dupCheck(vector<IndexChanges>& v, NamespaceDetails& d, DiskLoc curObjLoc);
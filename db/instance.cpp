@@ -23,6 +23,7 @@
 #include "repl.h"
 #include "dbmessage.h"
 #include "instance.h"
+#include "commands.h"
 #include "lasterror.h"
 #include "security.h"
 #include "json.h"
@@ -244,11 +245,66 @@ namespace mongo {
         ::abort();
     }
 
+    bool execCommand( Command * c ,
+                      Client& client , int queryOptions ,
+                      const char *ns, BSONObj& cmdObj ,
+                      BSONObjBuilder& result,
+                      bool fromRepl );
+
+    /* dbWriteAck: run the wrapped write, then reply with getLastError for it.  see dbmessage.h */
+    static void receivedWriteAck( Message& m, DbResponse& dbresponse, const HostAndPort& remote ) {
+        Message write;
+        BSONObj writeConcern;
+        try {
+            const char *p = m.singleData()->_data;
+            const char *end = p + m.header()->dataLen();
+            uassert( 15931, "bad writeack message", end - p >= 4 + 5 );
+            int writeOp = *reinterpret_cast< const int* >( p );
+            p += 4;
+            uassert( 15932, str::stream() << "writeack can't wrap op " << writeOp,
+                     writeOp == dbInsert || writeOp == dbUpdate || writeOp == dbDelete );
+            writeConcern = BSONObj( p );
+            uassert( 15933, "bad writeack message", writeConcern.objsize() < end - p );
+            p += writeConcern.objsize();
+
+            write.setData( writeOp, p, end - p );
+            write.header()->id = m.header()->id;
+        }
+        catch ( DBException& e ) {
+            BSONObjBuilder b;
+            b.append( "err", e.what() );
+            b.append( "code", e.getCode() );
+            b.append( "ok", 0.0 );
+            replyToQuery( ResultFlag_ErrSet, m, dbresponse, b.obj() );
+            return;
+        }
+
+        DbResponse none;
+        assembleResponse( write, none, remote );
+
+        BSONObjBuilder cmd;
+        cmd.append( "getlasterror", 1 );
+        cmd.appendElements( writeConcern );
+        BSONObj cmdObj = cmd.obj();
+
+        string cmdns = nsToDatabase( write.singleData()->_data + 4 ) + ".$cmd";
+        BSONObjBuilder result;
+        Command *c = Command::findCommand( "getlasterror" );
+        assert( c );
+        bool ok = execCommand( c, cc(), 0, cmdns.c_str(), cmdObj, result, false );
+        result.append( "ok", ok ? 1.0 : 0.0 );
+        replyToQuery( 0, m, dbresponse, result.obj() );
+    }
+
     // Returns false when request includes 'end'
     void assembleResponse( Message &m, DbResponse &dbresponse, const HostAndPort& remote ) {
 
         // before we lock...
         int op = m.operation();
+        if ( op == dbWriteAck ) {
+            receivedWriteAck( m, dbresponse, remote );
+            return;
+        }
         bool isCommand = false;
         const char *ns = m.singleData()->_data + 4;
         if ( op == dbQuery ) {
@@ -617,7 +673,8 @@ namespace mongo {
         return ok;
     }
 
-    void checkAndInsert(const char *ns, /*modifies*/BSONObj& js) { 
+    /** @param group if set the insert is logged through it rather than right away */
+    void checkAndInsert(const char *ns, /*modifies*/BSONObj& js, OpLogGroup *group = 0) { 
         uassert( 10059 , "object to insert too large", js.objsize() <= BSONObjMaxUserSize);
         {
             // check no $ modifiers.  note we only check top level.  (scanning deep would be quite expensive)
@@ -628,15 +685,27 @@ namespace mongo {
             }
         }
         theDataFileMgr.insertWithObjMod(ns, js, false); // js may be modified in the call to add an _id field.
-        logOp("i", ns, js);
+        if ( group )
+            group->add(js);
+        else
+            logOp("i", ns, js);
     }
 
     NOINLINE_DECL void insertMulti(bool keepGoing, const char *ns, vector<BSONObj>& objs) {
+        /* the oplog entries are written in groups.  not for system collections: an insert into
+           system.indexes can build an index in the background, which releases the lock.
+           whatever ends the loop, the group logs the documents inserted before it goes away. */
+        OpLogGroup group("i", ns);
+        OpLogGroup *g = strstr(ns, ".system.") ? 0 : &group;
+
         size_t i;
         for (i=0; i<objs.size(); i++){
             try {
-                checkAndInsert(ns, objs[i]);
-                getDur().commitIfNeeded();
+                checkAndInsert(ns, objs[i], g);
+                if ( getDur().aCommitIsNeeded() ) {
+                    group.flush();
+                    getDur().commitIfNeeded();
+                }
             } catch (const UserException&) {
                 if (!keepGoing || i == objs.size()-1){
                     globalOpCounters.incInsertInWriteLock(i);
@@ -646,6 +715,7 @@ namespace mongo {
             }
         }
 
+        group.flush();
         globalOpCounters.incInsertInWriteLock(i);
     }
 
@@ -459,12 +459,22 @@ namespace mongo {
         }
     }
 
+    /**
+     * @return true if the index key stores the raw value of field, so a match
+     * component on field may be checked against the key alone.  Plugin fields
+     * ( { a : "2d" }, { a : "hashed" } ) store a transformed value.
+     */
+    static bool keyFieldMatchable( const BSONObj &key, const char *field ) {
+        BSONElement e = key.getField( field );
+        return !e.eoo() && e.type() != String;
+    }
+
     Matcher::Matcher( const Matcher &docMatcher, const BSONObj &key ) :
         _where(0), _constrainIndexKey( key ), _haveSize(), _all(), _hasArray(0), _haveNeg(), _atomic(false) {
         // Filter out match components that will provide an incorrect result
         // given a key from a single key index.
         for( vector< ElementMatcher >::const_iterator i = docMatcher._basics.begin(); i != docMatcher._basics.end(); ++i ) {
-            if ( key.hasField( i->_toMatch.fieldName() ) ) {
+            if ( keyFieldMatchable( key, i->_toMatch.fieldName() ) ) {
                 switch( i->_compareOp ) {
                 case BSONObj::opSIZE:
                 case BSONObj::opALL:
@@ -499,7 +509,7 @@ namespace mongo {
         for( vector<RegexMatcher>::const_iterator it = docMatcher._regexs.begin();
 	     it != docMatcher._regexs.end();
 	     ++it) {
-	  if ( !it->_isNot && key.hasField( it->_fieldName ) ) {
+	  if ( !it->_isNot && keyFieldMatchable( key, it->_fieldName ) ) {
 	      _regexs.push_back(*it);
 	  }
         }
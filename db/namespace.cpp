@@ -591,6 +591,124 @@ namespace mongo {
 
     /* ------------------------------------------------------------------------- */
 
+    /* ------------------------------------------------------------------------- */
+
+    const double RecordGrowthStats::GrowthPercentile = 0.9;
+    const double RecordGrowthStats::bucketBounds[RecordGrowthStats::NBuckets] =
+        { 0, 1.0/32, 1.0/16, 1.0/8, 1.0/4, 1.0/2, 1.0, 1.0 };
+
+    void RecordGrowthStats::reset() {
+        memset(_hist, 0, sizeof(_hist));
+        _samples = 0;
+        _updates = 0;
+        _moves = 0;
+        _slackFactor = 1.0;
+    }
+
+    void RecordGrowthStats::noteUpdate(int oldSize, int newSize, bool moved) {
+        _updates++;
+        if( moved )
+            _moves++;
+
+        double growth = 0;
+        if( newSize > oldSize && oldSize > 0 )
+            growth = double(newSize - oldSize) / oldSize;
+        int b = 0;
+        while( b < NBuckets-1 && growth > bucketBounds[b] )
+            b++;
+        _hist[b]++;
+
+        if( ++_samples >= MaxSamples ) {
+            // decay so that we follow changes in the workload
+            _samples = 0;
+            for( int i = 0; i < NBuckets; i++ ) {
+                _hist[i] /= 2;
+                _samples += _hist[i];
+            }
+        }
+        recompute();
+    }
+
+    void RecordGrowthStats::recompute() {
+        if( _samples < MinSamples ) {
+            _slackFactor = 1.0;
+            return;
+        }
+        unsigned want = (unsigned) (_samples * GrowthPercentile);
+        unsigned n = 0;
+        int b = 0;
+        for( ; b < NBuckets-1; b++ ) {
+            n += _hist[b];
+            if( n >= want )
+                break;
+        }
+        _slackFactor = 1.0 + bucketBounds[b];
+    }
+
+    void RecordGrowthStats::appendStats(BSONObjBuilder& b) const {
+        b.appendNumber("updates", _updates);
+        b.appendNumber("moves", _moves);
+        b.append("moveRate", moveRate());
+        b.append("slackFactor", _slackFactor);
+        BSONArrayBuilder h(b.subarrayStart("growthHistogram"));
+        for( int i = 0; i < NBuckets; i++ )
+            h.append((int) _hist[i]);
+        h.done();
+    }
+
+    /* ------------------------------------------------------------------------- */
+
+    void OplogStartIndex::reset() {
+        scoped_lock lk(_m);
+        _starts.clear();
+        _seeded = false;
+        _bytesSinceSample = 0;
+    }
+
+    void OplogStartIndex::inserted(const OpTime& ts, const DiskLoc& loc, int lenWHdr) {
+        if( _bytesSinceSample > 0 && _bytesSinceSample < SampleBytes ) {
+            _bytesSinceSample += lenWHdr;
+            return;
+        }
+        scoped_lock lk(_m);
+        _starts[ts.asDate()] = loc;
+        _bytesSinceSample = lenWHdr;
+    }
+
+    void OplogStartIndex::seed(NamespaceDetails *d) {
+        _seeded = true;
+        for( DiskLoc e = d->firstExtent; !e.isNull(); e = e.ext()->xnext ) {
+            DiskLoc first = e.ext()->firstRecord;
+            if( first.isNull() )
+                continue;
+            BSONElement ts = BSONObj( first.rec() )["ts"];
+            if( ts.type() == Timestamp )
+                _starts[ts._opTime().asDate()] = first;
+        }
+        if( d->capLooped() && !d->capFirstNewRecord.isNull() ) {
+            BSONElement ts = BSONObj( d->capFirstNewRecord.rec() )["ts"];
+            if( ts.type() == Timestamp )
+                _starts[ts._opTime().asDate()] = d->capFirstNewRecord;
+        }
+    }
+
+    DiskLoc OplogStartIndex::find(NamespaceDetails *d, const OpTime& t, const OpTime& oldest) {
+        scoped_lock lk(_m);
+        if( !_seeded )
+            seed(d);
+        // records older than the oldest one left have been overwritten by the capped collection
+        _starts.erase( _starts.begin(), _starts.lower_bound( oldest.asDate() ) );
+        map<unsigned long long, DiskLoc>::const_iterator i = _starts.upper_bound( t.asDate() );
+        if( i == _starts.begin() )
+            return DiskLoc();
+        return (--i)->second;
+    }
+
+    unsigned OplogStartIndex::size() const {
+        scoped_lock lk(_m);
+        return _starts.size();
+    }
+
     SimpleMutex NamespaceDetailsTransient::_qcMutex("qc");
     SimpleMutex NamespaceDetailsTransient::_isMutex("is");
     map< string, shared_ptr< NamespaceDetailsTransient > > NamespaceDetailsTransient::_nsdMap;
@@ -601,6 +719,7 @@ namespace mongo {
         clearQueryCache();
         _keysComputed = false;
         _indexSpecs.clear();
+        _oplogStarts.reset();
     }
 
     void NamespaceDetailsTransient::clearForPrefix(const char *prefix) {
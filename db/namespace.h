@@ -404,6 +404,81 @@ namespace mongo {
     }; // NamespaceDetails
 #pragma pack()
 
+    /* RecordGrowthStats
+
+       histogram of how much records of a collection grow when updated, relative to their size before
+       the update.  paddingFactor only learns from whether an update moved; this lets insert() reserve
+       the slack a typical record will actually need (e.g. documents grown by $push).  kept in memory
+       only (lives in NamespaceDetailsTransient); old samples decay so the policy follows the workload.
+    */
+    class RecordGrowthStats {
+    public:
+        enum { NBuckets = 8, MinSamples = 64, MaxSamples = 16 * 1024 };
+
+        RecordGrowthStats() { reset(); }
+        void reset();
+
+        /* called for every update of a record.  sizes are bson object sizes. moved is true if the
+           new version did not fit in the old record. */
+        void noteUpdate(int oldSize, int newSize, bool moved);
+
+        /* @return multiplier ( >= 1.0 ) for the allocation size of a new record, chosen so that
+                   about GrowthPercentile of observed updates fit in place.  1.0 until we have
+                   MinSamples samples.
+        */
+        double slackFactor() const { return _slackFactor; }
+
+        long long updates() const { return _updates; }
+        long long moves() const { return _moves; }
+        double moveRate() const { return _updates ? double(_moves) / _updates : 0; }
+
+        void appendStats(BSONObjBuilder& b) const;
+
+        static const double GrowthPercentile;
+        /* upper bound of each bucket as growth/oldSize.  the last bucket is open ended. */
+        static const double bucketBounds[NBuckets];
+    private:
+        void recompute();
+        unsigned _hist[NBuckets];
+        unsigned _samples;
+        long long _updates;
+        long long _moves;
+        double _slackFactor;
+    };
+
+    /* OplogStartIndex
+
+       sparse ts -> DiskLoc map of a capped collection read with QueryOption_OplogReplay (an oplog),
+       so FindingStartCursor can start a { ts : { $gte : t } } scan right before t instead of walking
+       back from the newest record.  seeded with the first record of each extent on first use, then
+       fed a sample every SampleBytes of fast_oplog_insert()s.  entries older than the oldest record
+       left in the collection are dropped lazily.  kept in memory only (lives in
+       NamespaceDetailsTransient, which is cleared when the collection is emptied, truncated or
+       dropped and when its database is closed).
+    */
+    class OplogStartIndex : boost::noncopyable {
+    public:
+        enum { SampleBytes = 1024 * 1024 };
+
+        OplogStartIndex() : _m("OplogStartIndex") { reset(); }
+        void reset();
+
+        /* called for every record appended to the collection, in the write lock */
+        void inserted(const OpTime& ts, const DiskLoc& loc, int lenWHdr);
+
+        /* @param oldest ts of the oldest record in the collection
+           @return the newest known record with ts <= t, null if there isn't one */
+        DiskLoc find(NamespaceDetails *d, const OpTime& t, const OpTime& oldest);
+
+        unsigned size() const;
+    private:
+        void seed(NamespaceDetails *d);
+        mutable mongo::mutex _m;
+        map<unsigned long long, DiskLoc> _starts;
+        bool _seeded;
+        int _bytesSinceSample;
+    };
+
     /* NamespaceDetailsTransient
 
        these are things we know / compute about a namespace that are transient -- things
@@ -473,6 +548,18 @@ namespace mongo {
             return _indexKeys;
         }
 
+        /* record growth statistics, see RecordGrowthStats.  assumed to be in write lock for updates. */
+    private:
+        RecordGrowthStats _growthStats;
+    public:
+        RecordGrowthStats& growthStats() { return _growthStats; }
+
+        /* ts -> DiskLoc index for OplogReplay queries, see FindingStartCursor */
+    private:
+        OplogStartIndex _oplogStarts;
+    public:
+        OplogStartIndex& oplogStarts() { return _oplogStarts; }
+
         /* IndexSpec caching */
     private:
         map<const IndexDetails*,IndexSpec> _indexSpecs;
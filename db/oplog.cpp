@@ -47,6 +47,11 @@ namespace mongo {
         resetSlaveCache();
     }
 
+    /** let FindingStartCursor know where the op at ts went */
+    static void noteOplogInsert(const char *logns, const OpTime& ts, const DiskLoc& loc, int len) {
+        NamespaceDetailsTransient::get(logns).oplogStarts().inserted(ts, loc, len + Record::HeaderSize);
+    }
+
     static void _logOpUninitialized(const char *opstr, const char *ns, const char *logNS, const BSONObj& obj, BSONObj *o2, bool *bb ) {
         uassert(13288, "replSet error write op to db before replSet initialized", str::startsWith(ns, "local.") || *opstr == 'n');
     }
@@ -72,8 +77,10 @@ namespace mongo {
             Client::Context ctx( logns , localDB, false );
             {
                 int len = op.objsize();
-                Record *r = theDataFileMgr.fast_oplog_insert(rsOplogDetails, logns, len);
+                DiskLoc loc;
+                Record *r = theDataFileMgr.fast_oplog_insert(rsOplogDetails, logns, len, &loc);
                 memcpy(getDur().writingPtr(r->data, len), op.objdata(), len);
+                noteOplogInsert(logns, ts, loc, len);
             }
             /* todo: now() has code to handle clock skew.  but if the skew server to server is large it will get unhappy.
                      this code (or code in now() maybe) should be improved.
@@ -98,11 +105,17 @@ namespace mongo {
         @dst   where to put the newly built combined object.  e.g. ends up as something like:
                { ts:..., ns:..., os2:..., o:... }
     */
+    static void fill_O_Obj(void *p, const BSONObj& partial, const BSONObj& o);
     void append_O_Obj(char *dst, const BSONObj& partial, const BSONObj& o) {
         const int size1 = partial.objsize() - 1;  // less the EOO char
         const int oOfs = size1+3;                 // 3 = byte BSONOBJTYPE + byte 'o' + byte \0
 
-        void *p = getDur().writingPtr(dst, oOfs+o.objsize()+1);
+        fill_O_Obj(getDur().writingPtr(dst, oOfs+o.objsize()+1), partial, o);
+    }
+
+    /** append_O_Obj for a destination the caller has already declared for writing */
+    static void fill_O_Obj(void *p, const BSONObj& partial, const BSONObj& o) {
+        const int size1 = partial.objsize() - 1;  // less the EOO char
 
         memcpy(p, partial.objdata(), size1);
 
@@ -174,7 +187,9 @@ namespace mongo {
                 massert(13347, "local.oplog.rs missing. did you drop it? if so restart server", rsOplogDetails);
             }
             Client::Context ctx( logns , localDB, false );
-            r = theDataFileMgr.fast_oplog_insert(rsOplogDetails, logns, len);
+            DiskLoc loc;
+            r = theDataFileMgr.fast_oplog_insert(rsOplogDetails, logns, len, &loc);
+            noteOplogInsert(logns, ts, loc, len);
             /* todo: now() has code to handle clock skew.  but if the skew server to server is large it will get unhappy.
                      this code (or code in now() maybe) should be improved.
                      */
@@ -197,6 +212,98 @@ namespace mongo {
         }
     }
 
+    /** the group form of _logOpRS: logs opstr on ns with each of objs as its o field.
+
+        the records are allocated back to back before any is filled in.  when they land
+        contiguously -- the usual case, short of moving on to the next extent -- their contents
+        are declared to the journal as a single range instead of one intent per op.
+    */
+    static void _logOpsRS(const char *opstr, const char *ns, const vector<BSONObj>& objs) {
+        DEV assertInWriteLock();
+
+        if ( strncmp(ns, "local.", 6) == 0 ) {
+            if ( strncmp(ns, "local.slaves", 12) == 0 )
+                resetSlaveCache();
+            return;
+        }
+        if ( objs.empty() )
+            return;
+
+        assert( theReplSet );
+        massert(15949, "replSet error : logOps() but not primary?", theReplSet->box.getState().primary());
+
+        const char *logns = rsoplog;
+        if ( rsOplogDetails == 0 ) {
+            Client::Context ctx( logns , dbpath, false);
+            localDB = ctx.db();
+            assert( localDB );
+            rsOplogDetails = nsdetails(logns);
+            massert(15950, "local.oplog.rs missing. did you drop it? if so restart server", rsOplogDetails);
+        }
+
+        const size_t n = objs.size();
+        vector<BSONObj> partials(n);
+        vector<OpTime> times(n);
+        vector<int> lens(n);
+        long long hashNew = theReplSet->lastH;
+        long long totalLen = 0;
+        for( size_t i = 0; i < n; i++ ) {
+            times[i] = OpTime::now();
+            hashNew = (hashNew * 131 + times[i].asLL()) * 17 + theReplSet->selfId();
+            BSONObjBuilder b;
+            b.appendTimestamp("ts", times[i].asDate());
+            b.append("h", hashNew);
+            b.append("op", opstr);
+            b.append("ns", ns);
+            partials[i] = b.obj();
+            lens[i] = partials[i].objsize() + objs[i].objsize() + 1 + 2 /*o:*/;
+            totalLen += lens[i] + Record::HeaderSize;
+        }
+
+        /* allocating the whole group first would let a group larger than the capped space
+           overwrite its own earliest records.  that can't happen with less than half an extent. */
+        if ( totalLen > rsOplogDetails->lastExtentSize / 2 ) {
+            for( size_t i = 0; i < n; i++ )
+                _logOpRS(opstr, ns, 0, objs[i], 0, 0);
+            return;
+        }
+
+        Client::Context ctx( logns , localDB, false );
+        if( !(theReplSet->lastOpTimeWritten<times[0]) ) {
+            log() << "replSet ERROR possible failover clock skew issue? " << theReplSet->lastOpTimeWritten << ' ' << times[0] << rsLog;
+            log() << "replSet " << theReplSet->isPrimary() << rsLog;
+        }
+
+        vector<Record*> recs(n);
+        bool contiguous = true;
+        DiskLoc prev;
+        for( size_t i = 0; i < n; i++ ) {
+            DiskLoc loc;
+            recs[i] = theDataFileMgr.fast_oplog_insert(rsOplogDetails, logns, lens[i], &loc);
+            noteOplogInsert(logns, times[i], loc, lens[i]);
+            if( i > 0 && ( loc.a() != prev.a() || loc.getOfs() != prev.getOfs() + recs[i-1]->lengthWithHeaders ) )
+                contiguous = false;
+            prev = loc;
+        }
+
+        if( contiguous ) {
+            char *start = recs[0]->data;
+            char *p = static_cast<char*>( getDur().writingPtr(start, (recs[n-1]->data + lens[n-1]) - start) );
+            for( size_t i = 0; i < n; i++ )
+                fill_O_Obj(p + (recs[i]->data - start), partials[i], objs[i]);
+        }
+        else {
+            for( size_t i = 0; i < n; i++ )
+                append_O_Obj(recs[i]->data, partials[i], objs[i]);
+        }
+
+        theReplSet->lastOpTimeWritten = times[n-1];
+        theReplSet->lastH = hashNew;
+        ctx.getClient()->setLastOp( times[n-1] );
+
+        LOG(6) << "logOps: " << n << " ops on " << ns << (contiguous ? "" : ", not contiguous") << endl;
+    }
+
     /* we write to local.opload.$main:
          { ts : ..., op: ..., ns: ..., o: ... }
        ts: an OpTime timestamp
@@ -260,13 +367,17 @@ namespace mongo {
                 assert( localOplogMainDetails );
             }
             Client::Context ctx( logNS , localDB, false );
-            r = theDataFileMgr.fast_oplog_insert(localOplogMainDetails, logNS, len);
+            DiskLoc loc;
+            r = theDataFileMgr.fast_oplog_insert(localOplogMainDetails, logNS, len, &loc);
+            noteOplogInsert(logNS, ts, loc, len);
         }
         else {
             Client::Context ctx( logNS, dbpath, false );
             assert( nsdetails( logNS ) );
             // first we allocate the space, then we fill it below.
-            r = theDataFileMgr.fast_oplog_insert( nsdetails( logNS ), logNS, len);
+            DiskLoc loc;
+            r = theDataFileMgr.fast_oplog_insert( nsdetails( logNS ), logNS, len, &loc);
+            noteOplogInsert(logNS, ts, loc, len);
         }
 
         append_O_Obj(r->data, partial, obj);
@@ -316,6 +427,21 @@ namespace mongo {
         logOpForSharding( opstr , ns , obj , patt );
     }
 
+    void logOps(const char *opstr, const char *ns, const vector<BSONObj>& objs) {
+        if ( replSettings.master ) {
+            if ( _logOp == _logOpRS ) {
+                _logOpsRS(opstr, ns, objs);
+            }
+            else {
+                for( vector<BSONObj>::const_iterator i = objs.begin(); i != objs.end(); ++i )
+                    _logOp(opstr, ns, 0, *i, 0, 0);
+            }
+        }
+
+        for( vector<BSONObj>::const_iterator i = objs.begin(); i != objs.end(); ++i )
+            logOpForSharding( opstr , ns , *i , 0 );
+    }
+
     void createOplog() {
         dblock lk;
 
@@ -511,6 +637,26 @@ namespace mongo {
         return !c->ok() || _matcher->matchesCurrent( c.get() );
     }
     
+    DiskLoc FindingStartCursor::indexedStartLoc( const BSONElement &tsElt ) const {
+        // only { ts : t }, { ts : { $gt : t } } and { ts : { $gte : t }, ... } are known
+        // not to match anything older than t
+        BSONElement t = tsElt;
+        if ( tsElt.type() == Object ) {
+            t = tsElt.embeddedObject().firstElement();
+            int op = t.getGtLtOp();
+            if ( op != BSONObj::GT && op != BSONObj::GTE )
+                return DiskLoc();
+        }
+        if ( t.type() != Timestamp && t.type() != Date )
+            return DiskLoc();
+
+        shared_ptr<Cursor> c = _qp.newCursor();
+        if ( !c->ok() )
+            return DiskLoc();
+        OpTime oldest = c->current()[ "ts" ]._opTime();
+        return NamespaceDetailsTransient::get( _qp.ns() ).oplogStarts().find( _qp.nsd() , t._opTime() , oldest );
+    }
+
     void FindingStartCursor::init() {
         BSONElement tsElt = _qp.originalQuery()[ "ts" ];
         massert( 13044, "no ts field in query", !tsElt.eoo() );
@@ -523,6 +669,13 @@ namespace mongo {
             _findingStart = false;
             return;
         }
+        DiskLoc start = indexedStartLoc( tsElt );
+        if ( !start.isNull() ) {
+            // nothing before start can match, scan forward from there
+            createClientCursor( start );
+            _findingStartMode = InExtent;
+            return;
+        }
         // Use a ClientCursor here so we can release db mutex while scanning
         // oplog (can take quite a while with large oplogs).
         shared_ptr<Cursor> c = _qp.newReverseCursor();
@@ -624,6 +777,72 @@ namespace mongo {
         }
     }
 
+    static void prefetchIndexKeys(NamespaceDetails *d, const BSONObj& obj, PrefetchStats& stats) {
+        NamespaceDetails::IndexIterator i = d->ii();
+        while( i.more() ) {
+            IndexDetails& idx = i.next();
+            BSONObjSet keys;
+            idx.getKeysFromObject(obj, keys);
+            if ( keys.empty() )
+                continue;
+            Ordering ordering = Ordering::make(idx.keyPattern());
+            for( BSONObjSet::const_iterator k = keys.begin(); k != keys.end(); ++k ) {
+                int pos;
+                bool found;
+                idx.idxInterface().locate(idx, idx.head, *k, ordering, pos, found, minDiskLoc);
+                stats.indexKeys++;
+            }
+        }
+    }
+
+    void prefetchOp(const BSONObj& op, PrefetchStats& stats) {
+        dbMutex.assertAtLeastReadLocked();
+
+        const char *ns = op.getStringField("ns");
+        const char opType = *op.getStringField("op");
+        if ( *ns == 0 || *ns == '.' || ( opType != 'i' && opType != 'u' && opType != 'd' ) )
+            return;
+
+        try {
+            Client::Context ctx( ns );
+            NamespaceDetails *d = nsdetails( ns );
+            if ( !d )
+                return;
+            stats.ops++;
+
+            BSONObj o = op.getObjectField("o");
+            if ( opType == 'i' ) {
+                prefetchIndexKeys(d, o, stats);
+                return;
+            }
+
+            // update or delete: the existing document, found through _id
+            BSONObj pattern = opType == 'u' ? op.getObjectField("o2") : o;
+            BSONElement _id;
+            if ( pattern.getObjectID(_id) && d->findIdIndex() >= 0 ) {
+                BSONObjBuilder b;
+                b.append(_id);
+                DiskLoc loc = Helpers::findById(d, b.done());
+                stats.indexKeys++;
+                if ( !loc.isNull() ) {
+                    Record *r = loc.rec();
+                    stats.records++;
+                    if ( r->likelyInPhysicalMemory() )
+                        stats.recordsInMemory++;
+                    // keys the applier will remove
+                    prefetchIndexKeys(d, BSONObj(r), stats);
+                }
+            }
+
+            // replacement style update: keys the applier will add
+            if ( opType == 'u' && *o.firstElementFieldName() != '$' )
+                prefetchIndexKeys(d, o, stats);
+        }
+        catch( DBException& e ) {
+            log(2) << "ignoring assertion in prefetchOp() " << e.toString() << endl;
+        }
+    }
+
     BSONObj Sync::getMissingDoc(const BSONObj& o) {
         OplogReader missingObjReader;
 
@@ -51,6 +51,50 @@ namespace mongo {
     */
     void logOp(const char *opstr, const char *ns, const BSONObj& obj, BSONObj *patt = 0, bool *b = 0);
 
+    /** logOp(opstr, ns, obj) for each of objs, with the oplog records allocated and written as a group */
+    void logOps(const char *opstr, const char *ns, const vector<BSONObj>& objs);
+
+    /**
+     * collects the ops of a multi document write and hands them to logOps in groups of up to
+     * MaxOps ops or MaxBytes bytes.  the objects must stay valid until flushed.  flush before
+     * anything that may release the write lock or commit the journal, so that every op goes
+     * in with its oplog entry and the oplog keeps the order the ops were applied in.  what is
+     * still collected when the group goes out of scope, by an exception included, is flushed
+     * then, so declare the group inside the write lock.
+     */
+    class OpLogGroup : boost::noncopyable {
+    public:
+        static const unsigned MaxOps = 1000;
+        static const int MaxBytes = 4 * 1024 * 1024;
+
+        OpLogGroup(const char *opstr, const char *ns) : _opstr(opstr), _ns(ns), _bytes(0) { }
+
+        ~OpLogGroup() {
+            DESTRUCTOR_GUARD( flush(); )
+        }
+
+        void add(const BSONObj& o) {
+            _objs.push_back(o);
+            _bytes += o.objsize();
+            if ( _objs.size() >= MaxOps || _bytes >= MaxBytes )
+                flush();
+        }
+
+        void flush() {
+            if ( _objs.empty() )
+                return;
+            logOps(_opstr, _ns, _objs);
+            _objs.clear();
+            _bytes = 0;
+        }
+
+    private:
+        const char *_opstr;
+        const char *_ns;
+        vector<BSONObj> _objs;
+        int _bytes;
+    };
+
     void logKeepalive();
 
     /** puts obj in the oplog as a comment (a no-op).  Just for diags.
@@ -120,6 +164,7 @@ namespace mongo {
         }
         void init();
         bool firstDocMatchesOrEmpty() const;
+        DiskLoc indexedStartLoc( const BSONElement &tsElt ) const;
     };
 
     class Sync {
@@ -139,6 +184,25 @@ namespace mongo {
     void pretouchOperation(const BSONObj& op);
     void pretouchN(vector<BSONObj>&, unsigned a, unsigned b);
 
+    /** what prefetchOp() touched, summed over calls */
+    struct PrefetchStats {
+        PrefetchStats() : ops(0), records(0), recordsInMemory(0), indexKeys(0) {}
+        void add(const PrefetchStats& o) {
+            ops += o.ops; records += o.records; recordsInMemory += o.recordsInMemory; indexKeys += o.indexKeys;
+        }
+        long long ops;
+        long long records;          // existing documents the op will modify
+        long long recordsInMemory;  // ... of which were (likely) resident already
+        long long indexKeys;        // btree paths walked, _id and secondary indexes
+    };
+
+    /**
+     * bring into memory what applying op will touch: the document it modifies
+     * and the btree path of every index key it will add or remove.
+     * read lock must be held.  never throws.
+     */
+    void prefetchOp(const BSONObj& op, PrefetchStats& stats);
+
     /**
      * take an op and apply locally
      * used for applying from an oplog
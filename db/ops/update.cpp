@@ -970,6 +970,129 @@ namespace mongo {
         uassert( 12522 , "$ operator made object too large" , newObj.objsize() <= BSONObjMaxUserSize );
     }
 
+    /* apply pending index changes of a batched multi update without losing the cursor's position */
+    static void flushIndexBatch( IndexUpdateBatch& batch, MultiCursor& c, ClientCursor *cc ) {
+        if ( batch.empty() )
+            return;
+        if ( cc )
+            cc->updateLocation();
+        else
+            c.noteLocation();
+        batch.flush();
+        c.checkLocation();
+    }
+
+    /** replacements smaller than this are logged whole, a delta wouldn't save much */
+    static const int ReplacementDeltaMinSize = 1024;
+
+    /** can a top level field be named in a $set or $unset that stands in for a replacement */
+    static bool deltaFieldOk( const char *fieldName ) {
+        return *fieldName && *fieldName != '$' && strchr( fieldName , '.' ) == 0 && strcmp( fieldName , "_id" ) != 0;
+    }
+
+    static bool sameElement( const BSONElement& l , const BSONElement& r ) {
+        return l.size() == r.size() && memcmp( l.rawdata() , r.rawdata() , l.size() ) == 0;
+    }
+
+    /** do l and r have the same field names in the same order */
+    static bool sameFieldNames( const BSONObj& l , const BSONObj& r ) {
+        BSONObjIterator i( l );
+        BSONObjIterator j( r );
+        while ( i.more() && j.more() ) {
+            if ( strcmp( i.next().fieldName() , j.next().fieldName() ) != 0 )
+                return false;
+        }
+        return ! i.more() && ! j.more();
+    }
+
+    BSONObj replacementDelta( const BSONObj& from , const BSONObj& to ) {
+        if ( to.objsize() < ReplacementDeltaMinSize )
+            return BSONObj();
+
+        // what updateRecord stores: from's _id is put back first if to has none
+        BSONObj stored = to;
+        BSONElement id = from["_id"];
+        if ( ! id.eoo() && to["_id"].eoo() ) {
+            BSONObjBuilder b( to.objsize() + id.size() );
+            b.append( id );
+            b.appendElements( to );
+            stored = b.obj();
+        }
+
+        map<string,BSONElement> storedFields;
+        {
+            BSONObjIterator i( stored );
+            while ( i.more() ) {
+                BSONElement e = i.next();
+                if ( ! storedFields.insert( make_pair( string( e.fieldName() ) , e ) ).second )
+                    return BSONObj(); // duplicate field names
+            }
+        }
+
+        BSONObjBuilder sets , unsets;
+        bool changes = false;
+        set<string> fromFields;
+        {
+            BSONObjIterator i( from );
+            while ( i.more() ) {
+                BSONElement e = i.next();
+                fromFields.insert( e.fieldName() );
+                map<string,BSONElement>::const_iterator f = storedFields.find( e.fieldName() );
+                if ( f == storedFields.end() ) {
+                    if ( ! deltaFieldOk( e.fieldName() ) )
+                        return BSONObj();
+                    unsets.append( e.fieldName() , 1 );
+                    changes = true;
+                }
+                else if ( ! sameElement( e , f->second ) ) {
+                    if ( ! deltaFieldOk( e.fieldName() ) )
+                        return BSONObj();
+                    sets.append( f->second );
+                    changes = true;
+                }
+            }
+        }
+        {
+            BSONObjIterator i( stored );
+            while ( i.more() ) {
+                BSONElement e = i.next();
+                if ( fromFields.count( e.fieldName() ) )
+                    continue;
+                if ( ! deltaFieldOk( e.fieldName() ) )
+                    return BSONObj();
+                sets.append( e );
+                changes = true;
+            }
+        }
+        if ( ! changes )
+            return BSONObj();
+
+        BSONObjBuilder b;
+        BSONObj s = sets.obj();
+        BSONObj u = unsets.obj();
+        if ( ! s.isEmpty() )
+            b.append( "$set" , s );
+        if ( ! u.isEmpty() )
+            b.append( "$unset" , u );
+        BSONObj delta = b.obj();
+        if ( delta.objsize() >= stored.objsize() )
+            return BSONObj();
+
+        /* the mods must rebuild exactly the stored object, field order included: applied in place
+           they only overwrite values, so the fields must already be the stored ones in the stored
+           order; otherwise the object is rebuilt in field name order. */
+        ModSet mods( delta );
+        auto_ptr<ModSetState> mss = mods.prepare( from );
+        if ( mss->canApplyInPlace() ) {
+            if ( ! sameFieldNames( from , stored ) )
+                return BSONObj();
+        }
+        else if ( ! mss->createNewFromMods().binaryEqual( stored ) ) {
+            return BSONObj();
+        }
+        return delta;
+    }
+
     /* note: this is only (as-is) called for
 
              - not multi
@@ -1064,9 +1187,10 @@ namespace mongo {
         BSONElementManipulator::lookForTimestamps( updateobj );
         checkNoMods( updateobj );
         assert(nsdt);
+        BSONObj delta = logop ? replacementDelta( BSONObj( r ) , updateobj ) : BSONObj();
         theDataFileMgr.updateRecord(ns, d, nsdt, r, loc , updateobj.objdata(), updateobj.objsize(), debug );
         if ( logop ) {
-            logOp("u", ns, updateobj, &patternOrig );
+            logOp("u", ns, delta.isEmpty() ? updateobj : delta, &patternOrig );
         }
         return UpdateResult( 1 , 0 , 1 );
     }
@@ -1130,6 +1254,9 @@ namespace mongo {
             set<DiskLoc> seenObjects;
             MatchDetails details;
             auto_ptr<ClientCursor> cc;
+            auto_ptr<IndexUpdateBatch> batch;
+            if ( multi && modsIsIndexed > 0 && multiUpdateIndexBatchSize )
+                batch.reset( new IndexUpdateBatch( ns, multiUpdateIndexBatchSize ) );
             do {
                 nscanned++;
 
@@ -1142,8 +1269,11 @@ namespace mongo {
                         cc.reset( new ClientCursor( QueryOption_NoCursorTimeout , cPtr , ns ) );
                     }
     
-                    bool didYield;
-                    if ( ! cc->yieldSometimes( ClientCursor::WillNeed, &didYield ) ) {
+                    // we don't yield with batched index changes pending, they are flushed when the batch
+                    // fills up or on the periodic yields below
+                    bool didYield = false;
+                    if ( ( ! batch.get() || batch->empty() ) &&
+                         ! cc->yieldSometimes( ClientCursor::WillNeed, &didYield ) ) {
                         cc.release();
                         break;
                     }
@@ -1167,6 +1297,8 @@ namespace mongo {
                             shared_ptr< Cursor > cPtr = c;
                             cc.reset( new ClientCursor( QueryOption_NoCursorTimeout , cPtr , ns ) );
                         }
+                        if ( batch.get() )
+                            flushIndexBatch( *batch, *c, cc.get() );
                         if ( ! cc->yield() ) {
                             cc.release();
                             // TODO should we assert or something?
@@ -1265,7 +1397,7 @@ namespace mongo {
 
                         BSONObj newObj = mss->createNewFromMods();
                         checkTooLarge(newObj);
-                        DiskLoc newLoc = theDataFileMgr.updateRecord(ns, d, nsdt, r, loc , newObj.objdata(), newObj.objsize(), debug);
+                        DiskLoc newLoc = theDataFileMgr.updateRecord(ns, d, nsdt, r, loc , newObj.objdata(), newObj.objsize(), debug, false, batch.get());
                         if ( newLoc != loc || modsIsIndexed ){
                             // log() << "Moved obj " << newLoc.obj()["_id"] << " from " << loc << " to " << newLoc << endl;
                             // object moved, need to make sure we don' get again
@@ -1298,11 +1430,16 @@ namespace mongo {
                     if ( indexHack )
                         c->checkLocation();
 
+                    if ( batch.get() && ( batch->full() || getDur().aCommitIsNeeded() ) )
+                        flushIndexBatch( *batch, *c, cc.get() );
+
                     if ( nscanned % 64 == 0 && ! atomic ) {
                         if ( cc.get() == 0 ) {
                             shared_ptr< Cursor > cPtr = c;
                             cc.reset( new ClientCursor( QueryOption_NoCursorTimeout , cPtr , ns ) );
                         }
+                        if ( batch.get() )
+                            flushIndexBatch( *batch, *c, cc.get() );
                         if ( ! cc->yield() ) {
                             cc.release();
                             break;
@@ -1323,13 +1460,18 @@ namespace mongo {
 
                 BSONElementManipulator::lookForTimestamps( updateobj );
                 checkNoMods( updateobj );
+                // work out the delta while the old version is still there to compare with
+                BSONObj delta = logop ? replacementDelta( js , updateobj ) : BSONObj();
                 theDataFileMgr.updateRecord(ns, d, nsdt, r, loc , updateobj.objdata(), updateobj.objsize(), debug, god);
                 if ( logop ) {
                     DEV wassert( !god ); // god doesn't get logged, this would be bad.
-                    logOp("u", ns, updateobj, &pattern );
+                    logOp("u", ns, delta.isEmpty() ? updateobj : delta, &pattern );
                 }
                 return UpdateResult( 1 , 0 , 1 );
             } while ( c->ok() );
+
+            if ( batch.get() )
+                batch->flush();
         } // endif
 
         if ( numModded )
@@ -1373,4 +1515,17 @@ namespace mongo {
         return _updateObjects(false, ns, updateobj, patternOrig, upsert, multi, logop, debug);
     }
 
+    class MultiUpdateIndexBatchSizeValidator : public ParameterValidator {
+    public:
+        MultiUpdateIndexBatchSizeValidator() : ParameterValidator( "multiUpdateIndexBatchSize" ) {}
+
+        virtual bool isValid( BSONElement e , string& errmsg ) const {
+            if ( ! e.isNumber() || e.numberInt() < 0 || e.numberInt() > 100000 ) {
+                errmsg = "multiUpdateIndexBatchSize has to be >= 0 and <= 100000";
+                return false;
+            }
+            return true;
+        }
+    } multiUpdateIndexBatchSizeValidator;
+
 }
@@ -43,6 +43,11 @@ namespace mongo {
 
     class RemoveSaver;
 
+    /* max # of index keys a multi update collects before applying them in key order (see IndexUpdateBatch).
+       0 means off.  set with setParameter multiUpdateIndexBatchSize.
+    */
+    extern unsigned multiUpdateIndexBatchSize;
+
     /* returns true if an existing object was updated, false if no existing object was found.
        multi - update multiple objects - mostly useful with things like $set
        god - allow access to system namespaces
@@ -51,6 +56,12 @@ namespace mongo {
     UpdateResult _updateObjects(bool god, const char *ns, const BSONObj& updateobj, BSONObj pattern,
                                 bool upsert, bool multi , bool logop , OpDebug& debug , RemoveSaver * rs = 0 );
 
+    /* for the oplog entry of a replacement-style update of from with to: a { $set, $unset } object
+       that rebuilds exactly what updateRecord stores, when that is smaller.  otherwise an empty object,
+       and to is logged whole.  secondaries replay it like any other $ update.
+    */
+    BSONObj replacementDelta( const BSONObj& from , const BSONObj& to );
+
 
 
     // ---------- private -------------
@@ -1045,7 +1045,7 @@ namespace mongo {
         NamespaceDetails *d,
         NamespaceDetailsTransient *nsdt,
         Record *toupdate, const DiskLoc& dl,
-        const char *_buf, int _len, OpDebug& debug,  bool god) {
+        const char *_buf, int _len, OpDebug& debug,  bool god, IndexUpdateBatch *batch) {
 
         dassert( toupdate == dl.rec() );
 
@@ -1080,13 +1080,17 @@ namespace mongo {
             // doesn't fit.  reallocate -----------------------------------------------------
             uassert( 10003 , "failing update: objects in a capped ns cannot grow", !(d && d->capped));
             d->paddingTooSmall();
+            nsdt->growthStats().noteUpdate(objOld.objsize(), objNew.objsize(), true);
             debug.moved = true;
+            if ( batch )
+                batch->flush(); // deleteRecord() and insert() touch the indexes directly
             deleteRecord(ns, toupdate, dl);
             return insert(ns, objNew.objdata(), objNew.objsize(), god);
         }
 
         nsdt->notifyOfWriteOp();
         d->paddingFits();
+        nsdt->growthStats().noteUpdate(objOld.objsize(), objNew.objsize(), false);
 
         /* have any index keys changed? */
         {
@@ -1094,6 +1098,14 @@ namespace mongo {
             int z = d->nIndexesBeingBuilt();
             for ( int x = 0; x < z; x++ ) {
                 IndexDetails& idx = d->idx(x);
+                if ( batch && x < d->nIndexes && IndexUpdateBatch::canDefer(idx) ) {
+                    for ( unsigned i = 0; i < changes[x].removed.size(); i++ )
+                        batch->remove(x, *changes[x].removed[i], dl);
+                    for ( unsigned i = 0; i < changes[x].added.size(); i++ )
+                        batch->add(x, *changes[x].added[i], dl);
+                    keyUpdates += changes[x].added.size();
+                    continue;
+                }
                 IndexInterface& ii = idx.idxInterface();
                 for ( unsigned i = 0; i < changes[x].removed.size(); i++ ) {
                     try {
@@ -1949,6 +1961,13 @@ namespace mongo {
             *getDur().writing(&d->paddingFactor) = 1.0;
             lenWHdr = len + Record::HeaderSize;
         }
+        if( !god && !d->capped ) {
+            // reserve the slack that updates of this collection have needed recently; paddingFactor
+            // still covers what the growth histogram does not predict.
+            double slack = NamespaceDetailsTransient::get(ns).growthStats().slackFactor();
+            if( slack > 1.0 )
+                lenWHdr = max(lenWHdr, (int) ((len + Record::HeaderSize) * slack));
+        }
 
         // If the collection is capped, check if the new object will violate a unique index
         // constraint before allocating space.
@@ -2065,7 +2084,7 @@ namespace mongo {
     /* special version of insert for transaction logging -- streamlined a bit.
        assumes ns is capped and no indexes
     */
-    Record* DataFileMgr::fast_oplog_insert(NamespaceDetails *d, const char *ns, int len) {
+    Record* DataFileMgr::fast_oplog_insert(NamespaceDetails *d, const char *ns, int len, DiskLoc *newLoc) {
         assert( d );
         RARELY assert( d == nsdetails(ns) );
         DEV assert( d == nsdetails(ns) );
@@ -2102,6 +2121,8 @@ namespace mongo {
             s->nrecords++;
         }
 
+        if ( newLoc )
+            *newLoc = loc;
         return r;
     }
 
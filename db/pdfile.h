@@ -40,6 +40,7 @@ namespace mongo {
     class Record;
     class Cursor;
     class OpDebug;
+    class IndexUpdateBatch;
 
     void dropDatabase(string db);
     bool repairDatabase(string db, string &errmsg, bool preserveClonedFilesOnFailure = false, bool backupOriginalFiles = false);
@@ -120,7 +121,7 @@ namespace mongo {
             NamespaceDetails *d,
             NamespaceDetailsTransient *nsdt,
             Record *toupdate, const DiskLoc& dl,
-            const char *buf, int len, OpDebug& debug, bool god=false);
+            const char *buf, int len, OpDebug& debug, bool god=false, IndexUpdateBatch *batch=0);
 
         // The object o may be updated if modified on insert.
         void insertAndLog( const char *ns, const BSONObj &o, bool god = false );
@@ -141,7 +142,8 @@ namespace mongo {
            assumes ns is capped and no indexes
            no _id field check
         */
-        Record* fast_oplog_insert(NamespaceDetails *d, const char *ns, int len);
+        /** @param loc if not null, set to where the record went */
+        Record* fast_oplog_insert(NamespaceDetails *d, const char *ns, int len, DiskLoc *loc = 0);
 
         static Extent* getExtent(const DiskLoc& dl);
         static Record* getRecord(const DiskLoc& dl);
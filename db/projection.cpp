@@ -247,6 +247,11 @@ namespace mongo {
 
             if ( _source[k.fieldName()].type() ) {
 
+                if ( k.type() == String ) {
+                    // plugin index ( 2d, hashed ), key isn't the field value
+                    return 0;
+                }
+
                 if ( strchr( k.fieldName() , '.' ) ) {
                     // TODO we currently don't support dotted fields
                     //      SERVER-2104
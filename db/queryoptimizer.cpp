@@ -102,6 +102,12 @@ namespace mongo {
             return;
         }
 
+        // The keys of a plugin index aren't the raw field values, so bounds
+        // computed from this query can't be used to scan it.
+        const bool pluginKeys = _index->getSpec().getType() != 0;
+        if ( pluginKeys )
+            _unhelpful = true;
+
         const IndexSpec &idxSpec = _index->getSpec();
         BSONObjIterator o( order );
         BSONObjIterator k( idxKey );
@@ -162,10 +168,11 @@ doneCheckOrder:
             }
             orderFieldsUnindexed.erase( e.fieldName() );
         }
-        if ( !_scanAndOrderRequired &&
+        if ( !_scanAndOrderRequired && !pluginKeys &&
                 ( optimalIndexedQueryCount == _frs.nNontrivialRanges() ) )
             _optimal = true;
-        if ( exactIndexedQueryCount == _frs.nNontrivialRanges() &&
+        if ( !pluginKeys &&
+                exactIndexedQueryCount == _frs.nNontrivialRanges() &&
                 orderFieldsUnindexed.size() == 0 &&
                 exactIndexedQueryCount == idxKey.nFields() &&
                 exactIndexedQueryCount == _originalQuery.nFields() ) {
@@ -1052,7 +1059,9 @@ doneCheckOrder:
                 return false;
             if ( strcmp( pe.fieldName(), ke.fieldName() ) != 0 )
                 return false;
-            if ( ( i == firstSignificantField ) && !( ( direction > 0 ) == ( pe.number() > 0 ) ) )
+            // index plugins such as hashed keep their keys ascending
+            bool ascending = pe.type() == String || pe.number() > 0;
+            if ( ( i == firstSignificantField ) && !( ( direction > 0 ) == ascending ) )
                 return false;
             ++i;
         }
@@ -1244,7 +1253,13 @@ doneCheckOrder:
             // No matches are possible in the index so the index may be useful.
             return true;   
         }
-        return d->idx( idxNo ).getSpec().suitability( frsp.simplifiedQueryForIndex( d, idxNo, keyPattern ), order ) != USELESS;
+        const IndexSpec &spec = d->idx( idxNo ).getSpec();
+        if ( spec.getType() ) {
+            // Plugin indexes are judged on the query QueryPlan will hand them, the
+            // simplified query loses e.g. the individual values of an $in.
+            return spec.suitability( frsp.originalQuery(), order ) != USELESS;
+        }
+        return spec.suitability( frsp.simplifiedQueryForIndex( d, idxNo, keyPattern ), order ) != USELESS;
     }
     
     void QueryUtilIndexed::clearIndexesForPatterns( const FieldRangeSetPair &frsp, const BSONObj &order ) {
@@ -430,6 +430,34 @@ namespace mongo {
         const Member *syncTarget = _currentSyncTarget;
         if (syncTarget && myState != MemberState::RS_PRIMARY) {
             b.append("syncingTo", syncTarget->fullName());
+            BSONObjBuilder sb(b.subobjStart("syncSource"));
+            sb.append("host", syncTarget->fullName());
+            sb.append("state", (int) syncTarget->state().s);
+            sb.append("pingMs", syncTarget->hbinfo().ping);
+            sb.append("lagSecs", (long long) syncTarget->hbinfo().opTime.getSecs() - (long long) lastOpTimeWritten.getSecs());
+            sb.done();
+        }
+        if (myState != MemberState::RS_PRIMARY && !_self->config().arbiterOnly) {
+            BSONObjBuilder bb(b.subobjStart("syncApply"));
+            const Member *primary = box.getPrimary();
+            if (primary) {
+                bb.append("lagSecs", (long long) primary->hbinfo().opTime.getSecs() - (long long) lastOpTimeWritten.getSecs());
+            }
+            _applyStats.append(bb);
+            BSONObjBuilder fb(bb.subobjStart("fetcher"));
+            _fetcherStats.append(fb);
+            fb.done();
+            bb.done();
+        }
+        if (_initialSyncStats.started()) {
+            BSONObjBuilder ib(b.subobjStart("initialSync"));
+            _initialSyncStats.append(ib);
+            ib.done();
+        }
+        if (_rollbackStats.any()) {
+            BSONObjBuilder rb(b.subobjStart("rollback"));
+            _rollbackStats.append(rb);
+            rb.done();
         }
         b.append("members", v);
         if( replSetBlind )
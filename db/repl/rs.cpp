@@ -340,6 +340,7 @@ namespace mongo {
         memset(_hbmsg, 0, sizeof(_hbmsg));
         strcpy( _hbmsg , "initial startup" );
         lastH = 0;
+        _prefetchPoolThreads = 0;
         changeState(MemberState::RS_STARTUP);
 
         _seeds = &replSetCmdline.seeds;
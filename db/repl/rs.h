@@ -21,6 +21,7 @@
 #include "../../util/concurrency/list.h"
 #include "../../util/concurrency/value.h"
 #include "../../util/concurrency/msg.h"
+#include "../../util/concurrency/thread_pool.h"
 #include "../../util/net/hostandport.h"
 #include "../commands.h"
 #include "../oplogreader.h"
@@ -28,6 +29,7 @@
 #include "rs_optime.h"
 #include "rs_member.h"
 #include "rs_config.h"
+#include "rs_fetcher.h"
 
 /**
  * Order of Events
@@ -44,6 +46,43 @@
 namespace mongo {
 
     struct HowToFixUp;
+    class CloneProgress;
+
+    /**
+     * progress of the clone phase of the last initial sync, reported by
+     * replSetGetStatus.  updated by the sync and clone threads, read by commands.
+     */
+    class InitialSyncStats {
+    public:
+        InitialSyncStats();
+        void start(unsigned threads);
+        void add(const shared_ptr<CloneProgress>& c);
+        /** totals, plus the progress of every collection not done yet */
+        void append(BSONObjBuilder& b) const;
+        bool started() const;
+    private:
+        mutable mongo::mutex _m;
+        unsigned _threads;
+        unsigned long long _started;
+        vector< shared_ptr<CloneProgress> > _collections;
+    };
+
+    /**
+     * what the last rollback did and how long each of its phases took, reported by
+     * replSetGetStatus.  written by the sync thread, read by commands.
+     */
+    class RollbackStats {
+    public:
+        RollbackStats();
+        void finished(const BSONObj& last);
+        void append(BSONObjBuilder& b) const;
+        bool any() const;
+    private:
+        mutable mongo::mutex _m;
+        unsigned _rollbacks;
+        BSONObj _last;
+    };
+
     struct Target;
     class DBClientConnection;
     class ReplSetImpl;
@@ -143,6 +182,34 @@ namespace mongo {
         void updateSlave(const mongo::OID& id, const OpTime& last);
     };
 
+    struct PrefetchStats;
+
+    /**
+     * counts and timings of the batches syncTail applies, reported by
+     * replSetGetStatus.  updated by the sync thread, read by commands.
+     */
+    class SyncApplyStats {
+    public:
+        SyncApplyStats();
+        void batchApplied(unsigned ops, long long applyMicros);
+        void batchPrefetched(const PrefetchStats& s, long long micros);
+        void append(BSONObjBuilder& b) const;
+    private:
+        mutable mongo::mutex _m;
+        long long _batches;
+        long long _ops;
+        long long _totalMicros;
+        long long _maxMicros;
+        unsigned _lastOps;
+        long long _lastMicros;
+        time_t _lastApplied;
+        long long _prefetchOps;
+        long long _prefetchRecords;
+        long long _prefetchRecordsInMemory;
+        long long _prefetchIndexKeys;
+        long long _prefetchMicros;
+    };
+
     struct Target;
 
     class Consensus {
@@ -497,9 +564,21 @@ namespace mongo {
         bool tryToGoLiveAsASecondary(OpTime&); // readlocks
         void syncTail();
         bool syncApply(const BSONObj &o);
+        long long slaveDelayRemaining(const BSONObj& op);
+        void waitForSlaveDelay(const BSONObj& op, const Member *target);
+        SyncApplyStats _applyStats;
+        OplogFetcherStats _fetcherStats;
+        InitialSyncStats _initialSyncStats;
+        RollbackStats _rollbackStats;
+        bool cloneAllDatabases(OplogReader& r, const string& sourceHostname);
+        bool syncApplyBatch(const vector<BSONObj>& ops, Member *target);
+        void prefetchBatch(const vector<BSONObj>& ops);
+        shared_ptr<ThreadPool> _prefetchPool;
+        unsigned _prefetchPoolThreads;
         unsigned _syncRollback(OplogReader& r);
         void syncRollback(OplogReader& r);
         void syncFixUp(HowToFixUp& h, OplogReader& r);
+        void noteRollback(HowToFixUp& h);
 
         // get an oplog reader for a server with an oplog entry timestamp greater
         // than or equal to minTS, if set.
@@ -0,0 +1,161 @@
+// @file rs_fetcher.cpp
+
+/*
+ *    Copyright (C) 2011 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pch.h"
+#include "rs_fetcher.h"
+#include "rs.h"
+#include "../../util/timer.h"
+
+namespace mongo {
+
+    OplogFetcherStats::OplogFetcherStats() :
+        _m("OplogFetcherStats"), _batches(0), _ops(0), _bytes(0), _fullWaitMicros(0), _emptyWaitMicros(0),
+        _maxBytes(0), _bufferedBatches(0), _bufferedOps(0), _bufferedBytes(0) {
+    }
+
+    void OplogFetcherStats::pushed(unsigned ops, long long bytes, long long waitMicros) {
+        scoped_lock lk(_m);
+        _batches++;
+        _ops += ops;
+        _bytes += bytes;
+        _fullWaitMicros += waitMicros;
+        _bufferedBatches++;
+        _bufferedOps += ops;
+        _bufferedBytes += bytes;
+    }
+
+    void OplogFetcherStats::popped(unsigned ops, long long bytes) {
+        scoped_lock lk(_m);
+        _bufferedBatches--;
+        _bufferedOps -= ops;
+        _bufferedBytes -= bytes;
+    }
+
+    void OplogFetcherStats::waitedForData(long long micros) {
+        scoped_lock lk(_m);
+        _emptyWaitMicros += micros;
+    }
+
+    void OplogFetcherStats::setMaxBytes(long long maxBytes) {
+        scoped_lock lk(_m);
+        _maxBytes = maxBytes;
+    }
+
+    void OplogFetcherStats::append(BSONObjBuilder& b) const {
+        scoped_lock lk(_m);
+        b.appendNumber("batches", _batches);
+        b.appendNumber("ops", _ops);
+        b.appendNumber("bytes", _bytes);
+        // time the fetcher waited for room, and the applier waited for data
+        b.appendNumber("bufferFullMillis", _fullWaitMicros / 1000);
+        b.appendNumber("bufferEmptyMillis", _emptyWaitMicros / 1000);
+        BSONObjBuilder buf(b.subobjStart("buffer"));
+        buf.appendNumber("maxBytes", _maxBytes);
+        buf.appendNumber("batches", _bufferedBatches);
+        buf.appendNumber("ops", _bufferedOps);
+        buf.appendNumber("bytes", _bufferedBytes);
+        buf.done();
+    }
+
+    OplogFetcher::OplogFetcher(OplogReader& r, OplogFetcherStats& stats) :
+        _r(r), _stats(stats), _buffer(MaxBufferBytes, &batchSize), _stopRequested(false), _finished(false) {
+        _stats.setMaxBytes(MaxBufferBytes);
+    }
+
+    OplogFetcher::~OplogFetcher() {
+        stop();
+    }
+
+    void OplogFetcher::_push(const BatchPtr& b) {
+        Timer t;
+        _buffer.push(b);
+        _stats.pushed(b->ops.size(), b->bytes, t.micros());
+    }
+
+    void OplogFetcher::run() {
+        string err;
+        try {
+            while( !_stopRequested && !inShutdown() ) {
+                if( !_r.more() ) {
+                    _r.tailCheck();
+                    if( !_r.haveCursor() ) {
+                        LOG(1) << "replSet fetcher cursor closed" << rsLog;
+                        break;
+                    }
+                    // looping back is ok because this is a tailable cursor
+                    continue;
+                }
+
+                // the objects point into the reader's current batch, which the next
+                // getMore replaces, so keep our own copies
+                BatchPtr b(new Batch());
+                while( _r.moreInCurrentBatch() ) {
+                    BSONObj o = _r.nextSafe().getOwned(); // note we might get "not master" at some point
+                    b->bytes += o.objsize();
+                    b->ops.push_back(o);
+                }
+                _push(b);
+            }
+        }
+        catch(DBException& e) {
+            err = e.toString();
+        }
+        catch(std::exception& e) {
+            err = e.what();
+        }
+        if( !err.empty() )
+            log() << "replSet fetcher stopping: " << err << rsLog;
+
+        BatchPtr last(new Batch());
+        last->last = true;
+        _buffer.push(last);
+    }
+
+    bool OplogFetcher::next(vector<BSONObj>& ops, int maxSecondsToWait) {
+        ops.clear();
+        if( _finished )
+            return false;
+
+        Timer t;
+        BatchPtr b;
+        bool got = _buffer.blockingPop(b, maxSecondsToWait);
+        _stats.waitedForData(t.micros());
+        if( !got )
+            return true;
+        if( b->last ) {
+            _finished = true;
+            return false;
+        }
+        _stats.popped(b->ops.size(), b->bytes);
+        ops.swap(b->ops);
+        return true;
+    }
+
+    void OplogFetcher::stop() {
+        if( getState() == NotStarted )
+            return;
+        _stopRequested = true;
+        // the fetcher may be blocked on a full buffer; keep making room until
+        // it has handed over its last batch
+        vector<BSONObj> discard;
+        while( next(discard) )
+            ;
+        wait();
+    }
+
+}
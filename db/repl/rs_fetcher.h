@@ -0,0 +1,105 @@
+// @file rs_fetcher.h
+
+/*
+ *    Copyright (C) 2011 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../../util/background.h"
+#include "../../util/queue.h"
+#include "../oplogreader.h"
+
+namespace mongo {
+
+    /**
+     * counters for the oplog fetcher and its buffer, reported by replSetGetStatus.
+     * updated by the fetcher and sync threads, read by commands.
+     */
+    class OplogFetcherStats {
+    public:
+        OplogFetcherStats();
+        void pushed(unsigned ops, long long bytes, long long waitMicros);
+        void popped(unsigned ops, long long bytes);
+        void waitedForData(long long micros);
+        void setMaxBytes(long long maxBytes);
+        void append(BSONObjBuilder& b) const;
+    private:
+        mutable mongo::mutex _m;
+        long long _batches;
+        long long _ops;
+        long long _bytes;
+        long long _fullWaitMicros;
+        long long _emptyWaitMicros;
+        long long _maxBytes;
+        long long _bufferedBatches;
+        long long _bufferedOps;
+        long long _bufferedBytes;
+    };
+
+    /**
+     * reads the oplog of the sync source on its own thread, ahead of the applier.
+     *
+     * each network batch the tailable cursor returns is copied into a bounded
+     * buffer, so the next getMore is already in flight while syncTail applies the
+     * previous one.  once the buffer holds MaxBufferBytes the fetcher blocks until
+     * the applier catches up.
+     *
+     * the fetcher owns the reader from go() until it is stopped: the caller must
+     * not use it in between.
+     */
+    class OplogFetcher : public BackgroundJob {
+    public:
+        static const size_t MaxBufferBytes = 64 * 1024 * 1024;
+
+        OplogFetcher(OplogReader& r, OplogFetcherStats& stats);
+
+        /** stops the fetcher if it is still running */
+        ~OplogFetcher();
+
+        string name() const { return "rsFetcher"; }
+
+        /**
+         * waits up to maxSecondsToWait for the next fetched batch.
+         * @return false once the fetcher has finished and everything it read
+         *         was returned; otherwise true, ops empty if nothing arrived in time
+         */
+        bool next(vector<BSONObj>& ops, int maxSecondsToWait = 1);
+
+        /** tells the fetcher to finish, discards what's buffered and waits for the thread */
+        void stop();
+
+    private:
+        struct Batch {
+            Batch() : bytes(0), last(false) { }
+            vector<BSONObj> ops;
+            size_t bytes;
+            bool last; // nothing follows, the fetcher is done
+        };
+        typedef shared_ptr<Batch> BatchPtr;
+
+        static size_t batchSize(const BatchPtr& b) { return b->bytes; }
+
+        void run();
+        void _push(const BatchPtr& b);
+
+        OplogReader& _r;
+        OplogFetcherStats& _stats;
+        BlockingQueue<BatchPtr> _buffer;
+        volatile bool _stopRequested;
+        bool _finished; // applier side: the last batch was popped
+    };
+
+}
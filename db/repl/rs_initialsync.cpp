@@ -24,6 +24,8 @@
 #include "../dbhelpers.h"
 #include "rs_optime.h"
 #include "../oplog.h"
+#include "../cloner.h"
+#include "../../util/timer.h"
 
 namespace mongo {
 
@@ -31,6 +33,8 @@ namespace mongo {
     using namespace bson;
 
     void dropAllDatabasesExceptLocal();
+    extern unsigned replInitialSyncCloneThreads;
+    extern unsigned replMaxSyncSourceLagSecs;
 
     // add try/catch with sleep
 
@@ -57,13 +61,190 @@ namespace mongo {
         }
     }
 
-    /* todo : progress metering to sethbmsg. */
-    static bool clone(const char *master, string db) {
-        string err;
-        return cloneFrom(master, err, db, false,
-                         /* slave_ok */ true, true, false, /*mayYield*/true, /*mayBeInterrupted*/false);
+    InitialSyncStats::InitialSyncStats() : _m("InitialSyncStats"), _threads(0), _started(0) {
     }
 
+    void InitialSyncStats::start(unsigned threads) {
+        scoped_lock lk(_m);
+        _threads = threads;
+        _started = curTimeMillis64();
+        _collections.clear();
+    }
+
+    void InitialSyncStats::add(const shared_ptr<CloneProgress>& c) {
+        scoped_lock lk(_m);
+        _collections.push_back(c);
+    }
+
+    bool InitialSyncStats::started() const {
+        scoped_lock lk(_m);
+        return _started != 0;
+    }
+
+    void InitialSyncStats::append(BSONObjBuilder& b) const {
+        scoped_lock lk(_m);
+        b.append("threads", _threads);
+        b.appendTimeT("started", _started / 1000);
+        long long docs = 0, bytes = 0;
+        unsigned done = 0;
+        BSONArrayBuilder inProgress;
+        for( unsigned i = 0; i < _collections.size(); i++ ) {
+            const CloneProgress& c = *_collections[i];
+            docs += c.docs();
+            bytes += c.bytes();
+            if( c.finished() ) {
+                done++;
+            }
+            else {
+                BSONObjBuilder cb(inProgress.subobjStart());
+                c.append(cb);
+                cb.done();
+            }
+        }
+        b.append("collections", (int) _collections.size());
+        b.append("collectionsCloned", done);
+        b.appendNumber("docs", docs);
+        b.appendNumber("bytes", bytes);
+        b.append("cloning", inProgress.arr());
+    }
+
+    /** the collections of an initial sync, shared by the clone threads */
+    struct CloneWork {
+        CloneWork(const string& h) : host(h), next(0), m("CloneWork") { }
+        const string host;
+        vector< pair<BSONObj, shared_ptr<CloneProgress> > > collections;
+        unsigned next;
+        string err; // first failure, the threads stop once set
+        mongo::mutex m;
+    };
+
+    /** clone collections until there are none left, each over a connection of its own */
+    static void cloneWorker(CloneWork *w) {
+        Client::initThread("rsClone");
+
+        while( 1 ) {
+            unsigned i;
+            {
+                scoped_lock lk(w->m);
+                if( w->next >= w->collections.size() || !w->err.empty() )
+                    break;
+                i = w->next++;
+            }
+            const BSONObj& collection = w->collections[i].first;
+            CloneProgress& progress = *w->collections[i].second;
+
+            const string& ns = progress.ns();
+            string errmsg;
+            bool ok = false;
+            progress.start();
+            try {
+                writelock lk(ns);
+                Client::Context ctx(ns);
+                ok = cloneCollectionFrom(w->host, collection, /*logForReplication*/false, /*slaveOk*/true, /*mayYield*/true, &progress, errmsg);
+            }
+            catch(DBException& e) {
+                errmsg = e.toString();
+            }
+            progress.finish(ok);
+
+            BSONObjBuilder b;
+            progress.append(b);
+            if( ok ) {
+                log() << "replSet initial sync cloned " << b.done() << rsLog;
+            }
+            else {
+                log() << "replSet initial sync error cloning " << b.done() << ' ' << errmsg << rsLog;
+                scoped_lock lk(w->m);
+                if( w->err.empty() )
+                    w->err = ns + ": " + errmsg;
+            }
+        }
+
+        cc().shutdown();
+    }
+
+    /**
+     * clone every collection of every database but local from the sync source,
+     * replInitialSyncCloneThreads collections at a time.  each collection has its own
+     * connection, so one collection's documents stream in while another's are
+     * being inserted or indexed under the write lock.
+     */
+    bool ReplSetImpl::cloneAllDatabases(OplogReader& r, const string& sourceHostname) {
+        unsigned threads = replInitialSyncCloneThreads;
+        _initialSyncStats.start(threads);
+
+        CloneWork w(sourceHostname);
+        list<string> dbs = r.conn()->getDatabaseNames();
+        for( list<string>::iterator i = dbs.begin(); i != dbs.end(); i++ ) {
+            string db = *i;
+            if( db == "local" )
+                continue;
+
+            {
+                // create it even if it turns out to have no collections
+                writelock lk(db);
+                Client::Context ctx(db);
+            }
+
+            list<BSONObj> l;
+            string errmsg;
+            if( !collectionsToClone(r.conn(), db, /*slaveOk*/true, l, errmsg) ) {
+                sethbmsg( str::stream() << "initial sync error listing collections of " << db << ": " << errmsg, 0);
+                return false;
+            }
+            for( list<BSONObj>::iterator j = l.begin(); j != l.end(); j++ ) {
+                shared_ptr<CloneProgress> p( new CloneProgress((*j)["name"].String()) );
+                _initialSyncStats.add(p);
+                w.collections.push_back( make_pair(*j, p) );
+            }
+        }
+
+        sethbmsg( str::stream() << "initial sync cloning " << w.collections.size() << " collections, "
+                  << threads << " at a time", 0);
+
+        Timer t;
+        {
+            vector< shared_ptr<boost::thread> > workers;
+            for( unsigned i = 0; i < threads && i < w.collections.size(); i++ )
+                workers.push_back( shared_ptr<boost::thread>( new boost::thread( boost::bind(&cloneWorker, &w) ) ) );
+            for( unsigned i = 0; i < workers.size(); i++ )
+                workers[i]->join();
+        }
+
+        if( !w.err.empty() ) {
+            sethbmsg( str::stream() << "initial sync error clone of " << w.err, 0);
+            return false;
+        }
+        log() << "replSet initial sync cloned " << w.collections.size() << " collections in " << t.millis() << "ms" << rsLog;
+        return true;
+    }
+
+    class ReplInitialSyncCloneThreadsValidator : public ParameterValidator {
+    public:
+        ReplInitialSyncCloneThreadsValidator() : ParameterValidator( "replInitialSyncCloneThreads" ) {}
+
+        virtual bool isValid( BSONElement e , string& errmsg ) const {
+            if( !e.isNumber() || e.numberInt() < 1 || e.numberInt() > 32 ) {
+                errmsg = "replInitialSyncCloneThreads has to be >= 1 and <= 32";
+                return false;
+            }
+            return true;
+        }
+    } replInitialSyncCloneThreadsValidator;
+
+    class ReplMaxSyncSourceLagSecsValidator : public ParameterValidator {
+    public:
+        ReplMaxSyncSourceLagSecsValidator() : ParameterValidator( "replMaxSyncSourceLagSecs" ) {}
+
+        virtual bool isValid( BSONElement e , string& errmsg ) const {
+            if( !e.isNumber() || e.numberInt() < 0 || e.numberInt() > 3600 ) {
+                errmsg = "replMaxSyncSourceLagSecs has to be >= 0 and <= 3600";
+                return false;
+            }
+            return true;
+        }
+    } replMaxSyncSourceLagSecsValidator;
+
     void _logOpObjRS(const BSONObj& op);
 
     static void emptyOplog() {
@@ -79,6 +260,11 @@ namespace mongo {
         d->emptyCappedCollection(rsoplog);
     }
 
+    /**
+     * pick the closest member, by heartbeat ping time, that has more data than we do and is
+     * within replMaxSyncSourceLagSecs of the freshest such member.  secondaries qualify as
+     * well as the primary, so members far from the primary can chain off a nearby secondary.
+     */
     Member* ReplSetImpl::getMemberToSyncTo() {
         Member *closest = 0;
         time_t now = 0;
@@ -96,35 +282,48 @@ namespace mongo {
             buildIndexes = myConfig().buildIndexes;
         }
 
-        // find the member with the lowest ping time that has more data than me
+        // members that have more data than me and aren't vetoed
+        vector<Member*> candidates;
+        OpTime freshest;
         for (Member *m = _members.head(); m; m = m->next()) {
-            if (m->hbinfo().up() &&
+            if (!m->hbinfo().up() ||
                 // make sure members with buildIndexes sync from other members w/indexes
-                (!buildIndexes || (buildIndexes && m->config().buildIndexes)) &&
-                (m->state() == MemberState::RS_PRIMARY ||
-                 (m->state() == MemberState::RS_SECONDARY && m->hbinfo().opTime > lastOpTimeWritten)) &&
-                (!closest || m->hbinfo().ping < closest->hbinfo().ping)) {
-
-                map<string,time_t>::iterator vetoed = _veto.find(m->fullName());
-                if (vetoed == _veto.end()) {
-                    closest = m;
-                    break;
-                }
+                (buildIndexes && !m->config().buildIndexes) ||
+                !(m->state() == MemberState::RS_PRIMARY ||
+                  (m->state() == MemberState::RS_SECONDARY && m->hbinfo().opTime > lastOpTimeWritten))) {
+                continue;
+            }
 
+            map<string,time_t>::iterator vetoed = _veto.find(m->fullName());
+            if (vetoed != _veto.end()) {
                 if (now == 0) {
                     now = time(0);
                 }
 
-                // if this was on the veto list, check if it was vetoed in the last "while"
-                if ((*vetoed).second < now) {
-                    _veto.erase(vetoed);
-                    closest = m;
-                    break;
+                // if it was recently vetoed, skip
+                if ((*vetoed).second >= now) {
+                    log() << "replSet not trying to sync from " << (*vetoed).first
+                          << ", it is vetoed for " << ((*vetoed).second - now) << " more seconds" << rsLog;
+                    continue;
                 }
+                _veto.erase(vetoed);
+            }
 
-                // if it was recently vetoed, skip
-                log() << "replSet not trying to sync from " << (*vetoed).first
-                      << ", it is vetoed for " << ((*vetoed).second - now) << " more seconds" << rsLog;
+            candidates.push_back(m);
+            if (m->hbinfo().opTime > freshest) {
+                freshest = m->hbinfo().opTime;
+            }
+        }
+
+        // of those close enough to the freshest, take the one with the lowest ping time
+        const long long maxLag = replMaxSyncSourceLagSecs;
+        for (vector<Member*>::const_iterator i = candidates.begin(); i != candidates.end(); ++i) {
+            Member *m = *i;
+            if ((long long) freshest.getSecs() - (long long) m->hbinfo().opTime.getSecs() > maxLag) {
+                continue;
+            }
+            if (!closest || m->hbinfo().ping < closest->hbinfo().ping) {
+                closest = m;
             }
         }
 
@@ -192,24 +391,11 @@ namespace mongo {
 
             sethbmsg("initial sync clone all databases", 0);
 
-            list<string> dbs = r.conn()->getDatabaseNames();
-            for( list<string>::iterator i = dbs.begin(); i != dbs.end(); i++ ) {
-                string db = *i;
-                if( db != "local" ) {
-                    sethbmsg( str::stream() << "initial sync cloning db: " << db , 0);
-                    bool ok;
-                    {
-                        writelock lk(db);
-                        Client::Context ctx(db);
-                        ok = clone(sourceHostname.c_str(), db);
-                    }
-                    if( !ok ) {
-                        sethbmsg( str::stream() << "initial sync error clone of " << db << " failed sleeping 5 minutes" ,0);
-                        veto(source->fullName(), 600);
-                        sleepsecs(300);
-                        return;
-                    }
-                }
+            if( !cloneAllDatabases(r, sourceHostname) ) {
+                log() << "replSet initial sync clone failed, sleeping 5 minutes" << rsLog;
+                veto(source->fullName(), 600);
+                sleepsecs(300);
+                return;
             }
         }
 
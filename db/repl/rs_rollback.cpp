@@ -24,6 +24,7 @@
 #include "../cloner.h"
 #include "../ops/update.h"
 #include "../ops/delete.h"
+#include "../../util/timer.h"
 
 /* Scenarios
 
@@ -84,6 +85,8 @@ namespace mongo {
     };
 
     struct HowToFixUp {
+        HowToFixUp() : rbid(0), refetchQueries(0), deletes(0), updates(0), result("incomplete") { }
+
         /* note this is a set -- if there are many $inc's on a single document we need to rollback, we only
            need to refetch it once. */
         set<DocID> toRefetch;
@@ -97,8 +100,43 @@ namespace mongo {
         DiskLoc commonPointOurDiskloc;
 
         int rbid; // remote server's current rollback sequence #
+
+        /* what we did, for RollbackStats */
+        unsigned refetchQueries;
+        unsigned deletes;
+        unsigned updates;
+        string result;
+
+        /* millis spent in each phase, in the order they ran */
+        Timer total;
+        Timer phaseTimer;
+        BSONObjBuilder phases;
+        void phaseDone(const char *phase) {
+            phases.appendNumber(phase, (long long) phaseTimer.millis());
+            phaseTimer.reset();
+        }
     };
 
+    RollbackStats::RollbackStats() : _m("RollbackStats"), _rollbacks(0) {
+    }
+
+    void RollbackStats::finished(const BSONObj& last) {
+        scoped_lock lk(_m);
+        _rollbacks++;
+        _last = last.getOwned();
+    }
+
+    bool RollbackStats::any() const {
+        scoped_lock lk(_m);
+        return _rollbacks > 0;
+    }
+
+    void RollbackStats::append(BSONObjBuilder& b) const {
+        scoped_lock lk(_m);
+        b.append("rollbacks", _rollbacks);
+        b.append("last", _last);
+    }
+
     static void refetch(HowToFixUp& h, const BSONObj& ourObj) {
         const char *op = ourObj.getStringField("op");
         if( *op == 'n' )
@@ -301,6 +339,48 @@ namespace mongo {
         }
     }
 
+    /** most _ids in one refetch query, and most bytes of them, keeping the query well under the max message size */
+    static const unsigned RefetchBatchMaxIds = 1000;
+    static const int RefetchBatchMaxIdBytes = 1024 * 1024;
+
+    /**
+     * refetches the documents in [i, end), all of one namespace, from the primary with a single
+     * $in query on _id.  each goes onto goodVersions with its current version, or an empty object
+     * if the primary no longer has it.
+     */
+    static void refetchBatch(DBClientConnection *them, set<DocID>::const_iterator i, set<DocID>::const_iterator end,
+                             list< pair<DocID,bo> >& goodVersions, unsigned long long& totSize) {
+        const char *ns = i->ns;
+        bob q;
+        {
+            bob id(q.subobjStart("_id"));
+            BSONArrayBuilder in(id.subarrayStart("$in"));
+            for( set<DocID>::const_iterator j = i; j != end; j++ )
+                in.append(j->_id);
+            in.done();
+            id.done();
+        }
+
+        /* the keys point into the documents they map to */
+        map<be,bo> found;
+        auto_ptr<DBClientCursor> c = them->query(ns, q.obj(), 0, 0, 0, QueryOption_SlaveOk);
+        uassert(15948, str::stream() << "replSet rollback refetch query failed for " << ns, c.get());
+        while( c->more() ) {
+            bo o = c->nextSafe().getOwned();
+            totSize += o.objsize();
+            uassert( 13410, "replSet too much data to roll back", totSize < 300 * 1024 * 1024 );
+            be _id = o["_id"];
+            if( !_id.eoo() )
+                found[_id] = o;
+        }
+
+        for( ; i != end; i++ ) {
+            map<be,bo>::const_iterator f = found.find(i->_id);
+            // note an empty object indicates we should delete it
+            goodVersions.push_back(pair<DocID,bo>(*i, f == found.end() ? bo() : f->second));
+        }
+    }
+
     struct X {
         const bson::bo *op;
         bson::bo goodVersionOfObject;
@@ -329,25 +409,31 @@ namespace mongo {
 
         bo newMinValid;
 
-        /* fetch all the goodVersions of each document from current primary */
+        /* fetch all the goodVersions of each document from current primary.  toRefetch is ordered by
+           ns first, so each run of one namespace goes as a few large $in queries rather than one
+           round trip per document. */
         DocID d;
         unsigned long long n = 0;
         try {
-            for( set<DocID>::iterator i = h.toRefetch.begin(); i != h.toRefetch.end(); i++ ) {
+            set<DocID>::const_iterator i = h.toRefetch.begin();
+            while( i != h.toRefetch.end() ) {
                 d = *i;
 
-                assert( !d._id.eoo() );
-
-                {
-                    /* TODO : slow.  lots of round trips. */
-                    n++;
-                    bo good= them->findOne(d.ns, d._id.wrap(), NULL, QueryOption_SlaveOk).getOwned();
-                    totSize += good.objsize();
-                    uassert( 13410, "replSet too much data to roll back", totSize < 300 * 1024 * 1024 );
-
-                    // note good might be eoo, indicating we should delete it
-                    goodVersions.push_back(pair<DocID,bo>(d,good));
+                set<DocID>::const_iterator end = i;
+                unsigned ids = 0;
+                int idBytes = 0;
+                while( end != h.toRefetch.end() && strcmp(end->ns, d.ns) == 0 &&
+                       ids < RefetchBatchMaxIds && idBytes < RefetchBatchMaxIdBytes ) {
+                    assert( !end->_id.eoo() );
+                    idBytes += end->_id.size();
+                    ids++;
+                    end++;
                 }
+
+                refetchBatch(them, i, end, goodVersions, totSize);
+                h.refetchQueries++;
+                n += ids;
+                i = end;
             }
             newMinValid = r.getLastOp(rsoplog);
             if( newMinValid.isEmpty() ) {
@@ -367,8 +453,10 @@ namespace mongo {
         if( h.rbid != getRBID(r.conn()) ) {
             // our source rolled back itself.  so the data we received isn't necessarily consistent.
             sethbmsg("rollback rbid on source changed during rollback, cancelling this attempt");
+            h.result = "source rolled back";
             return;
         }
+        h.phaseDone("refetch");
 
         // update them
         sethbmsg(str::stream() << "rollback 4 n:" << goodVersions.size());
@@ -436,6 +524,8 @@ namespace mongo {
             sethbmsg("rollback 4.3");
         }
 
+        h.phaseDone("resync");
+
         sethbmsg("rollback 4.6");
         /** drop collections to drop before doing individual fixups - that might make things faster below actually if there were subsequent inserts to rollback */
         for( set<string>::iterator i = h.toDrop.begin(); i != h.toDrop.end(); i++ ) {
@@ -451,6 +541,8 @@ namespace mongo {
             }
         }
 
+        h.phaseDone("drop");
+
         sethbmsg("rollback 4.7");
         Client::Context c(rsoplog);
         NamespaceDetails *oplogDetails = nsdetails(rsoplog);
@@ -517,7 +609,6 @@ namespace mongo {
                         }
                         else {
                             try {
-                                deletes++;
                                 deleteObjects(d.ns, pattern, /*justone*/true, /*logop*/false, /*god*/true, rs.get() );
                             }
                             catch(...) {
@@ -562,9 +653,12 @@ namespace mongo {
         }
 
         removeSavers.clear(); // this effectively closes all of them
+        h.deletes = deletes;
+        h.updates = updates;
 
         sethbmsg(str::stream() << "rollback 5 d:" << deletes << " u:" << updates);
         MemoryMappedFile::flushAll(true);
+        h.phaseDone("apply");
         sethbmsg("rollback 6");
 
         // clean up oplog
@@ -577,12 +671,34 @@ namespace mongo {
 
         sethbmsg("rollback 7");
         MemoryMappedFile::flushAll(true);
+        h.phaseDone("truncateOplog");
 
         // done
-        if( warn )
+        if( warn ) {
             sethbmsg("issues during syncRollback, see log");
-        else
+            h.result = "done with warnings";
+        }
+        else {
             sethbmsg("rollback done");
+            h.result = "done";
+        }
+    }
+
+    void ReplSetImpl::noteRollback(HowToFixUp& h) {
+        bob b;
+        b.appendTimeT("date", time(0));
+        b.append("result", h.result);
+        b.append("docs", (long long) h.toRefetch.size());
+        b.append("refetchQueries", h.refetchQueries);
+        b.append("deletes", h.deletes);
+        b.append("updates", h.updates);
+        b.append("collectionsResynced", (int) h.collectionsToResync.size());
+        b.append("collectionsDropped", (int) h.toDrop.size());
+        b.append("phaseMillis", h.phases.done());
+        b.appendNumber("totalMillis", (long long) h.total.millis());
+        bo last = b.obj();
+        log() << "replSet rollback " << last.toString() << rsLog;
+        _rollbackStats.finished(last);
     }
 
     void ReplSetImpl::syncRollback(OplogReader&r) {
@@ -621,6 +737,7 @@ namespace mongo {
             sethbmsg("rollback 2 FindCommonPoint");
             try {
                 syncRollbackFindCommonPoint(r.conn(), how);
+                how.phaseDone("findCommonPoint");
             }
             catch( const char *p ) {
                 sethbmsg(string("rollback 2 error ") + p);
@@ -647,13 +764,18 @@ namespace mongo {
             }
             catch( rsfatal& ) {
                 sethbmsg("rollback fixup error");
+                how.result = "fatal";
+                noteRollback(how);
                 _fatal();
                 return 2;
             }
             catch(...) {
+                how.result = "error";
+                noteRollback(how);
                 incRBID(); throw;
             }
             incRBID();
+            noteRollback(how);
 
             /* success - leave "ROLLBACK" state
                can go to SECONDARY once minvalid is achieved
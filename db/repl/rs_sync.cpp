@@ -20,11 +20,20 @@
 #include "rs.h"
 #include "../repl.h"
 #include "connections.h"
+#include "../oplog.h"
+#include "../../util/timer.h"
 
 namespace mongo {
 
     using namespace bson;
     extern unsigned replSetForceInitialSyncFailure;
+    extern unsigned replPrefetchThreads;
+
+    /** most oplog entries syncTail applies in a batch */
+    static const unsigned SyncBatchMaxOps = 1000;
+
+    /** about how long a batch holds the write lock before letting readers in */
+    static const int SyncBatchMaxLockMicros = 1000;
 
     void NOINLINE_DECL blank(const BSONObj& o) {
         if( *o.getStringField("op") != 'n' ) {
@@ -314,6 +323,165 @@ namespace mongo {
         return 0;
     }
 
+    /** @return seconds op must still wait for slaveDelay, <= 0 if it can be applied now */
+    long long ReplSetImpl::slaveDelayRemaining(const BSONObj& op) {
+        int sd = myConfig().slaveDelay;
+        // ignore slaveDelay if the box is still initializing. once
+        // it becomes secondary we can worry about it.
+        if( !sd || !box.getState().secondary() )
+            return 0;
+        const OpTime ts = op["ts"]._opTime();
+        long long lag = time(0) - (long long) ts.getSecs();
+        return sd - lag;
+    }
+
+    void ReplSetImpl::waitForSlaveDelay(const BSONObj& op, const Member *target) {
+        int sd = myConfig().slaveDelay;
+        long long sleeptime = slaveDelayRemaining(op);
+        if( sleeptime <= 0 )
+            return;
+        uassert(12000, "rs slaveDelay differential too big check clocks and systems", sleeptime < 0x40000000);
+        if( sleeptime < 60 ) {
+            sleepsecs((int) sleeptime);
+        }
+        else {
+            log() << "replSet slavedelay sleep long time: " << sleeptime << rsLog;
+            // sleep(hours) would prevent reconfigs from taking effect & such!
+            long long waitUntil = time(0) + sleeptime;
+            while( 1 ) {
+                sleepsecs(6);
+                if( time(0) >= waitUntil )
+                    break;
+
+                if( !target->hbinfo().hbstate.readable() ) {
+                    break;
+                }
+
+                if( myConfig().slaveDelay != sd ) // reconf
+                    break;
+            }
+        }
+    }
+
+    SyncApplyStats::SyncApplyStats() :
+        _m("SyncApplyStats"), _batches(0), _ops(0), _totalMicros(0), _maxMicros(0),
+        _lastOps(0), _lastMicros(0), _lastApplied(0),
+        _prefetchOps(0), _prefetchRecords(0), _prefetchRecordsInMemory(0), _prefetchIndexKeys(0), _prefetchMicros(0) {
+    }
+
+    void SyncApplyStats::batchPrefetched(const PrefetchStats& st, long long micros) {
+        scoped_lock lk(_m);
+        _prefetchOps += st.ops;
+        _prefetchRecords += st.records;
+        _prefetchRecordsInMemory += st.recordsInMemory;
+        _prefetchIndexKeys += st.indexKeys;
+        _prefetchMicros += micros;
+    }
+
+    void SyncApplyStats::batchApplied(unsigned ops, long long applyMicros) {
+        scoped_lock lk(_m);
+        _batches++;
+        _ops += ops;
+        _totalMicros += applyMicros;
+        _maxMicros = max(_maxMicros, applyMicros);
+        _lastOps = ops;
+        _lastMicros = applyMicros;
+        _lastApplied = time(0);
+    }
+
+    void SyncApplyStats::append(BSONObjBuilder& b) const {
+        scoped_lock lk(_m);
+        b.appendNumber("batches", _batches);
+        b.appendNumber("ops", _ops);
+        b.appendNumber("totalMillis", _totalMicros / 1000);
+        b.append("avgBatchOps", _batches ? (double) _ops / _batches : 0.0);
+        b.appendNumber("maxBatchMillis", _maxMicros / 1000);
+        BSONObjBuilder last(b.subobjStart("lastBatch"));
+        last.append("ops", _lastOps);
+        last.appendNumber("millis", _lastMicros / 1000);
+        last.appendTimeT("applied", _lastApplied);
+        last.done();
+        BSONObjBuilder pf(b.subobjStart("prefetch"));
+        pf.append("threads", replPrefetchThreads);
+        pf.appendNumber("ops", _prefetchOps);
+        pf.appendNumber("records", _prefetchRecords);
+        pf.appendNumber("recordsInMemory", _prefetchRecordsInMemory);
+        pf.appendNumber("indexKeys", _prefetchIndexKeys);
+        pf.appendNumber("totalMillis", _prefetchMicros / 1000);
+        pf.done();
+    }
+
+    /** prefetch the ops of one partition, on a pool thread */
+    static void prefetchPartition(const vector<BSONObj> *ops, vector<unsigned> part, PrefetchStats *total, mongo::mutex *m) {
+        if( currentClient.get() == 0 )
+            Client::initThread("rsPrefetch");
+
+        PrefetchStats st;
+        {
+            readlock lk("");
+            for( unsigned i = 0; i < part.size(); i++ )
+                prefetchOp((*ops)[part[i]], st);
+        }
+        scoped_lock lk(*m);
+        total->add(st);
+    }
+
+    /** ops on the same document hash to the same partition */
+    static unsigned prefetchPartitionOf(const BSONObj& op, unsigned n) {
+        unsigned h = 0;
+        for( const char *p = op.getStringField("ns"); *p; p++ )
+            h = h * 31 + *p;
+        const char opType = *op.getStringField("op");
+        BSONElement _id = ( opType == 'u' ? op.getObjectField("o2") : op.getObjectField("o") )["_id"];
+        if( !_id.eoo() ) {
+            const char *v = _id.value();
+            for( int i = 0; i < _id.valuesize(); i++ )
+                h = h * 31 + v[i];
+        }
+        return h % n;
+    }
+
+    /**
+     * touch what applying ops will touch, in parallel under read locks, so the
+     * applier doesn't fault pages in one at a time while holding the write lock.
+     */
+    void ReplSetImpl::prefetchBatch(const vector<BSONObj>& ops) {
+        unsigned n = replPrefetchThreads;
+        if( n == 0 || ops.empty() )
+            return;
+        if( n != _prefetchPoolThreads ) {
+            _prefetchPool.reset( new ThreadPool(n) );
+            _prefetchPoolThreads = n;
+        }
+
+        vector< vector<unsigned> > parts(n);
+        for( unsigned i = 0; i < ops.size(); i++ )
+            parts[prefetchPartitionOf(ops[i], n)].push_back(i);
+
+        Timer t;
+        PrefetchStats total;
+        mongo::mutex m("prefetchBatch");
+        for( unsigned i = 0; i < n; i++ ) {
+            if( !parts[i].empty() )
+                _prefetchPool->schedule(prefetchPartition, &ops, parts[i], &total, &m);
+        }
+        _prefetchPool->join();
+        _applyStats.batchPrefetched(total, t.micros());
+    }
+
+    class ReplPrefetchThreadsValidator : public ParameterValidator {
+    public:
+        ReplPrefetchThreadsValidator() : ParameterValidator( "replPrefetchThreads" ) {}
+
+        virtual bool isValid( BSONElement e , string& errmsg ) const {
+            if( !e.isNumber() || e.numberInt() < 0 || e.numberInt() > 32 ) {
+                errmsg = "replPrefetchThreads has to be >= 0 and <= 32";
+                return false;
+            }
+            return true;
+        }
+    } replPrefetchThreadsValidator;
+
     /* tail an oplog.  ok to return, will be re-called. */
     void ReplSetImpl::syncTail() {
         // todo : locking vis a vis the mgr...
@@ -385,113 +553,112 @@ namespace mongo {
             tryToGoLiveAsASecondary(minvalid);
         }
 
-        while( 1 ) {
-            {
-                Timer timeInWriteLock;
-                writelock lk("");
-                while( 1 ) {
-                    if( !r.moreInCurrentBatch() ) {
-                        dbtemprelease tempRelease;
-                        {
-                            // we need to occasionally check some things. between
-                            // batches is probably a good time.                            
-                            if( state().recovering() ) { // perhaps we should check this earlier? but not before the rollback checks.
-                                /* can we go to RS_SECONDARY state?  we can if not too old and if minvalid achieved */
-                                OpTime minvalid;
-                                bool golive = ReplSetImpl::tryToGoLiveAsASecondary(minvalid);
-                                if( golive ) {
-                                    ;
-                                }
-                                else {
-                                    sethbmsg(str::stream() << "still syncing, not yet to minValid optime" << minvalid.toString());
-                                }
-                                // todo: too stale capability
-                            }
-                            if( !target->hbinfo().hbstate.readable() ) {
-                                return;
-                            }
-                        }
-                        r.more(); // to make the requestmore outside the db lock, which obviously is quite important
-                    }
-                    if( timeInWriteLock.micros() > 1000 ) {
-                        dbtemprelease tempRelease;
-                        timeInWriteLock.reset();
-                    }
-                    if( !r.more() )
-                        break;
-                    {
-                        BSONObj o = r.nextSafe(); // note we might get "not master" at some point
-
-                        int sd = myConfig().slaveDelay;
-                        // ignore slaveDelay if the box is still initializing. once
-                        // it becomes secondary we can worry about it.
-                        if( sd && box.getState().secondary() ) {
-                            const OpTime ts = o["ts"]._opTime();
-                            long long a = ts.getSecs();
-                            long long b = time(0);
-                            long long lag = b - a;
-                            long long sleeptime = sd - lag;
-                            if( sleeptime > 0 ) {
-                                dbtemprelease tempRelease;
-                                uassert(12000, "rs slaveDelay differential too big check clocks and systems", sleeptime < 0x40000000);
-                                if( sleeptime < 60 ) {
-                                    sleepsecs((int) sleeptime);
-                                }
-                                else {
-                                    log() << "replSet slavedelay sleep long time: " << sleeptime << rsLog;
-                                    // sleep(hours) would prevent reconfigs from taking effect & such!
-                                    long long waitUntil = b + sleeptime;
-                                    while( 1 ) {
-                                        sleepsecs(6);
-                                        if( time(0) >= waitUntil )
-                                            break;
-
-                                        if( !target->hbinfo().hbstate.readable() ) {
-                                            break;
-                                        }
-                                    
-                                        if( myConfig().slaveDelay != sd ) // reconf
-                                            break;
-                                    }
-                                }
-                            }
-                        } // endif slaveDelay
-
-                        dbMutex.assertWriteLocked();
-                        try {
-                            /* if we have become primary, we dont' want to apply things from elsewhere
-                               anymore. assumePrimary is in the db lock so we are safe as long as
-                               we check after we locked above. */
-                            if( box.getState().primary() ) {
-                                log(0) << "replSet stopping syncTail we are now primary" << rsLog;
-                                return;
-                            }
+        /* the fetcher reads ahead on its own thread while we apply */
+        OplogFetcher fetcher(r, _fetcherStats);
+        fetcher.go();
 
-                            syncApply(o);
-                            _logOpObjRS(o);   // with repl sets we write the ops to our oplog too 
-                        }
-                        catch (DBException& e) {
-                            sethbmsg(str::stream() << "syncTail: " << e.toString() << ", syncing: " << o);
-                            veto(target->fullName(), 300);
-                            sleepsecs(30);
-                            return;
-                        }
-                    }
-                } // end while
-            } // end writelock scope
+        vector<BSONObj> fetched;
+        while( 1 ) {
+            // we need to occasionally check some things. between
+            // batches is probably a good time.
+            if( state().recovering() ) { // perhaps we should check this earlier? but not before the rollback checks.
+                /* can we go to RS_SECONDARY state?  we can if not too old and if minvalid achieved */
+                OpTime minvalid;
+                bool golive = ReplSetImpl::tryToGoLiveAsASecondary(minvalid);
+                if( golive ) {
+                    ;
+                }
+                else {
+                    sethbmsg(str::stream() << "still syncing, not yet to minValid optime" << minvalid.toString());
+                }
+                // todo: too stale capability
+            }
+            if( !target->hbinfo().hbstate.readable() ) {
+                return;
+            }
 
-            r.tailCheck();
-            if( !r.haveCursor() ) {
+            if( !fetcher.next(fetched) ) {
                 LOG(1) << "replSet end syncTail pass with " << hn << rsLog;
                 // TODO : reuse our connection to the primary.
                 return;
             }
-            
-            if( !target->hbinfo().hbstate.readable() ) {
+
+            /* apply what was fetched in chunks of at most SyncBatchMaxOps, each
+               taking the write lock for about SyncBatchMaxLockMicros at a time */
+            vector<BSONObj> ops;
+            for( unsigned i = 0; i < fetched.size(); i++ ) {
+                const BSONObj& o = fetched[i];
+                if( slaveDelayRemaining(o) > 0 ) {
+                    // apply what is due first
+                    if( !ops.empty() ) {
+                        if( !syncApplyBatch(ops, target) )
+                            return;
+                        ops.clear();
+                    }
+                    waitForSlaveDelay(o, target);
+                }
+                ops.push_back(o);
+                if( ops.size() >= SyncBatchMaxOps ) {
+                    if( !syncApplyBatch(ops, target) )
+                        return;
+                    ops.clear();
+                }
+            }
+            if( !ops.empty() && !syncApplyBatch(ops, target) )
                 return;
+        }
+    }
+
+    /** @return false if syncTail should stop: we became primary, or an op failed to apply */
+    bool ReplSetImpl::syncApplyBatch(const vector<BSONObj>& ops, Member *target) {
+        prefetchBatch(ops);
+
+        unsigned applied = 0;
+        while( applied < ops.size() ) {
+            writelock lk("");
+
+            /* if we have become primary, we dont' want to apply things from elsewhere
+               anymore. assumePrimary is in the db lock so we are safe as long as
+               we check after we locked above. */
+            if( box.getState().primary() ) {
+                log(0) << "replSet stopping syncTail we are now primary" << rsLog;
+                return false;
+            }
+
+            /* readers on a secondary wait for the write lock, so it is let go once about a
+               millisecond has gone by, as when ops were applied one at a time */
+            const unsigned start = applied;
+            Timer t;
+            string err;
+            bool failed = false;
+            try {
+                do {
+                    syncApply(ops[applied]);
+                    applied++;
+                } while( applied < ops.size() && t.micros() < SyncBatchMaxLockMicros );
+            }
+            catch (DBException& e) {
+                err = e.toString();
+                failed = true;
+            }
+
+            // with repl sets we write the ops to our oplog too, once they are applied
+            for( unsigned i = start; i < applied; i++ )
+                _logOpObjRS(ops[i]);
+            _applyStats.batchApplied(applied - start, t.micros());
+
+            if( failed ) {
+                sethbmsg(str::stream() << "syncTail: " << err << ", syncing: " << ops[applied]);
+                veto(target->fullName(), 300);
+                break;
             }
-            // looping back is ok because this is a tailable cursor
         }
+
+        if( applied < ops.size() ) {
+            sleepsecs(30);
+            return false;
+        }
+        return true;
     }
 
     void ReplSetImpl::_syncThread() {
@@ -22,6 +22,7 @@
 #include "instance.h"
 #include "dbhelpers.h"
 #include "../util/background.h"
+#include "../util/histogram.h"
 #include "../util/mongoutils/str.h"
 #include "../client/dbclient.h"
 #include "replutil.h"
@@ -70,6 +71,7 @@ namespace mongo {
         SlaveTracking() : _mutex("SlaveTracking") {
             _dirty = false;
             _started = false;
+            _generation = 0;
         }
 
         void run() {
@@ -107,6 +109,20 @@ namespace mongo {
         void reset() {
             scoped_lock mylk(_mutex);
             _slaves.clear();
+            _noteProgress();
+        }
+
+        unsigned long long generation() const {
+            scoped_lock mylk(_mutex);
+            return _generation;
+        }
+
+        /** waits until a slave reports a position after gen was read, or for maxMillis */
+        void awaitProgress( unsigned long long gen , int maxMillis ) {
+            scoped_lock mylk(_mutex);
+            if ( _generation != gen )
+                return;
+            _progress.timed_wait( mylk.boost() , incxtimemillis( maxMillis ) );
         }
 
         void update( const BSONObj& rid , const string& host , const string& ns , OpTime last ) {
@@ -114,6 +130,9 @@ namespace mongo {
 
             scoped_lock mylk(_mutex);
 
+            // waiters can't look until we release _mutex, by which time the new position is in
+            _noteProgress();
+
 #ifdef _DEBUG
             MongoFileAllowWrites allowWrites;
 #endif
@@ -212,8 +231,87 @@ namespace mongo {
         bool _dirty;
         bool _started;
 
+    private:
+        void _noteProgress() {
+            _generation++;
+            _progress.notify_all();
+        }
+
+        boost::condition _progress; // notified with _mutex held whenever a slave's position may have moved
+        unsigned long long _generation;
+
     } slaveTracking;
 
+    /**
+     * how long getLastError waited for w > 1 and w:<mode>, with a latency histogram for
+     * w:majority.  reported by serverStatus.
+     */
+    class WriteConcernStats {
+    public:
+        WriteConcernStats() : _m("WriteConcernStats"), _majorityMillis( histogramOptions() ) { }
+
+        void note( const BSONElement& w , int millis , bool timedOut ) {
+            bool majority = w.type() == String && strcmp( w.valuestr() , "majority" ) == 0;
+            scoped_lock lk(_m);
+            _all.note( millis , timedOut );
+            if ( majority ) {
+                _majority.note( millis , timedOut );
+                _majorityMillis.insert( millis );
+            }
+        }
+
+        void append( BSONObjBuilder& b ) const {
+            scoped_lock lk(_m);
+            _all.append( b );
+            BSONObjBuilder mb( b.subobjStart( "majority" ) );
+            _majority.append( mb );
+            BSONArrayBuilder hb( mb.subarrayStart( "histogramMillis" ) );
+            for ( boost::uint32_t i = 0; i < _majorityMillis.getBucketsNum(); i++ ) {
+                // the last bucket is unbounded
+                BSONObjBuilder bb( hb.subobjStart() );
+                if ( i + 1 < _majorityMillis.getBucketsNum() )
+                    bb.appendNumber( "upTo" , (long long) _majorityMillis.getBoundary( i ) );
+                bb.appendNumber( "count" , (long long) _majorityMillis.getCount( i ) );
+                bb.done();
+            }
+            hb.done();
+            mb.done();
+        }
+
+    private:
+        struct Totals {
+            Totals() : waits(0), timeouts(0), millis(0) { }
+            void note( int m , bool timedOut ) {
+                waits++;
+                if ( timedOut )
+                    timeouts++;
+                millis += m;
+            }
+            void append( BSONObjBuilder& b ) const {
+                b.appendNumber( "waits" , waits );
+                b.appendNumber( "timeouts" , timeouts );
+                b.appendNumber( "totalMillis" , millis );
+            }
+            long long waits;
+            long long timeouts;
+            long long millis;
+        };
+
+        /** 1, 2, 4 ... 16384ms and over */
+        static Histogram::Options histogramOptions() {
+            Histogram::Options o;
+            o.numBuckets = 16;
+            o.bucketSize = 1;
+            o.exponential = true;
+            return o;
+        }
+
+        mutable mongo::mutex _m;
+        Totals _all;
+        Totals _majority;
+        Histogram _majorityMillis;
+    } writeConcernStats;
+
     const char * SlaveTracking::NS = "local.slaves";
 
     void updateSlaveLocation( CurOp& curop, const char * ns , OpTime lastOp ) {
@@ -246,6 +344,24 @@ namespace mongo {
         return slaveTracking.replicatedToNum( op , w );
     }
 
+    unsigned long long slaveProgressGeneration() {
+        return slaveTracking.generation();
+    }
+
+    void awaitSlaveProgress( unsigned long long generation , int maxMillis ) {
+        slaveTracking.awaitProgress( generation , maxMillis );
+    }
+
+    void noteWriteConcernWait( const BSONElement& w , int millis , bool timedOut ) {
+        if ( w.isNumber() && w.numberInt() <= 1 )
+            return;
+        writeConcernStats.note( w , millis , timedOut );
+    }
+
+    void appendWriteConcernStats( BSONObjBuilder& b ) {
+        writeConcernStats.append( b );
+    }
+
     void resetSlaveCache() {
         slaveTracking.reset();
     }
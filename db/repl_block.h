@@ -34,6 +34,16 @@ namespace mongo {
     bool opReplicatedEnough( OpTime op , int w );
     bool opReplicatedEnough( OpTime op , BSONElement w );
 
+    /** changes whenever a slave reports a new position; read it before opReplicatedEnough */
+    unsigned long long slaveProgressGeneration();
+
+    /** blocks until slaveProgressGeneration() moves on from generation, or for at most maxMillis */
+    void awaitSlaveProgress( unsigned long long generation , int maxMillis );
+
+    /** records how long getLastError waited for w, for serverStatus */
+    void noteWriteConcernWait( const BSONElement& w , int millis , bool timedOut );
+    void appendWriteConcernStats( BSONObjBuilder& b );
+
     void resetSlaveCache();
     unsigned getSlaveCount();
 }
@@ -0,0 +1,216 @@
+// ttl.cpp
+
+/**
+*    Copyright (C) 2011 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "pch.h"
+#include "ttl.h"
+#include "pdfile.h"
+#include "btree.h"
+#include "oplog.h"
+#include "replutil.h"
+#include "../util/background.h"
+#include "../util/timer.h"
+
+namespace mongo {
+
+    class TTLMonitor : public BackgroundJob {
+    public:
+        TTLMonitor() : _statsMutex( "TTLMonitor" ) , _passes(0) , _totalRemoved(0) ,
+            _lastIndexes(0) , _lastRemoved(0) , _lastMillis(0) {
+        }
+
+        string name() const { return "TTLMonitor"; }
+
+        /** seconds between passes */
+        static const int SleepSecs = 60;
+
+        /** documents removed per write lock acquisition */
+        static const int BatchSize = 500;
+
+        void run() {
+            Client::initThread( name().c_str() );
+            Client& client = cc();
+
+            while ( ! inShutdown() ) {
+                sleepsecs( SleepSecs );
+                if ( inShutdown() )
+                    break;
+
+                try {
+                    doPass();
+                }
+                catch ( DBException& e ) {
+                    error() << "TTLMonitor pass failed: " << e.toString() << endl;
+                }
+            }
+
+            client.shutdown();
+        }
+
+        void appendStats( BSONObjBuilder& b ) {
+            scoped_lock lk( _statsMutex );
+            b.appendNumber( "passes" , _passes );
+            b.appendNumber( "totalRemoved" , _totalRemoved );
+            BSONObjBuilder last( b.subobjStart( "lastPass" ) );
+            last.append( "indexes" , _lastIndexes );
+            last.appendNumber( "removed" , _lastRemoved );
+            last.appendNumber( "ms" , _lastMillis );
+            last.append( "finished" , _lastFinished );
+            last.done();
+        }
+
+    private:
+
+        void doPass() {
+            Timer t;
+
+            set<string> dbs;
+            {
+                readlock lk( "" );
+                dbHolder().getAllShortNames( true , dbs );
+            }
+
+            vector<BSONObj> indexes;
+            for ( set<string>::const_iterator i = dbs.begin(); i != dbs.end(); ++i ) {
+                if ( *i == "local" )
+                    continue;
+                findTTLIndexes( *i , indexes );
+            }
+
+            long long removed = 0;
+            for ( unsigned i = 0; i < indexes.size() && ! inShutdown(); i++ ) {
+                try {
+                    removed += expire( indexes[i] );
+                }
+                catch ( DBException& e ) {
+                    error() << "TTLMonitor error expiring " << indexes[i] << ": " << e.toString() << endl;
+                }
+            }
+
+            int ms = t.millis();
+            log( removed ? 0 : 1 ) << "TTLMonitor removed " << removed << " documents from "
+                                  << indexes.size() << " indexes in " << ms << "ms" << endl;
+
+            scoped_lock lk( _statsMutex );
+            _passes++;
+            _totalRemoved += removed;
+            _lastIndexes = indexes.size();
+            _lastRemoved = removed;
+            _lastMillis = ms;
+            _lastFinished = jsTime();
+        }
+
+        void findTTLIndexes( const string& dbName , vector<BSONObj>& indexes ) {
+            string ns = dbName + ".system.indexes";
+            readlock lk( ns );
+            Client::Context ctx( ns );
+            if ( ! nsdetails( ns.c_str() ) )
+                return;
+            for ( shared_ptr<Cursor> c = theDataFileMgr.findAll( ns.c_str() ); c->ok(); c->advance() ) {
+                BSONObj idx = c->current();
+                if ( idx["expireAfterSeconds"].isNumber() )
+                    indexes.push_back( idx.getOwned() );
+            }
+        }
+
+        /**
+         * removes the documents whose indexed date is older than now - expireAfterSeconds,
+         * oldest first, BatchSize at a time
+         * @return number of documents removed
+         */
+        long long expire( const BSONObj& idx ) {
+            const string ns = idx["ns"].String();
+            const BSONObj key = idx["key"].Obj();
+
+            BSONObj startKey;
+            {
+                BSONObjBuilder b;
+                b.appendMinForType( "" , Date );
+                startKey = b.obj();
+            }
+            BSONObj endKey = BSON( "" << Date_t( jsTime() - (long long)( idx["expireAfterSeconds"].number() * 1000 ) ) );
+
+            long long removed = 0;
+            while ( ! inShutdown() ) {
+                int n = 0;
+                {
+                    writelock lk( ns );
+                    Client::Context ctx( ns );
+
+                    // secondaries get the deletes from the oplog
+                    if ( ! isMasterNs( ns.c_str() ) )
+                        break;
+
+                    NamespaceDetails *d = nsdetails( ns.c_str() );
+                    if ( ! d || d->capped )
+                        break;
+                    int idxNo = d->findIndexByKeyPattern( key );
+                    if ( idxNo < 0 || idxNo >= d->nIndexes )
+                        break; // dropped, or still being built in the background
+
+                    vector<DiskLoc> locs;
+                    {
+                        shared_ptr<Cursor> c( BtreeCursor::make( d , idxNo , d->idx( idxNo ) , startKey , endKey , false , 1 ) );
+                        for ( ; c->ok() && (int)locs.size() < BatchSize; c->advance() ) {
+                            if ( ! c->getsetdup( c->currLoc() ) )
+                                locs.push_back( c->currLoc() );
+                        }
+                    }
+
+                    for ( vector<DiskLoc>::const_iterator i = locs.begin(); i != locs.end(); ++i ) {
+                        BSONElement id;
+                        if ( BSONObj( i->rec() ).getObjectID( id ) ) {
+                            BSONObjBuilder b;
+                            b.append( id );
+                            bool replJustOne = true;
+                            logOp( "d" , ns.c_str() , b.done() , 0 , &replJustOne );
+                        }
+                        else {
+                            problem() << "TTLMonitor deleted object without id, not logging" << endl;
+                        }
+                        theDataFileMgr.deleteRecord( ns.c_str() , i->rec() , *i );
+                        n++;
+                    }
+                    getDur().commitIfNeeded();
+                }
+
+                removed += n;
+                if ( n < BatchSize )
+                    break;
+            }
+            return removed;
+        }
+
+        mongo::mutex _statsMutex;
+        long long _passes;
+        long long _totalRemoved;
+        int _lastIndexes;
+        long long _lastRemoved;
+        long long _lastMillis;
+        Date_t _lastFinished;
+
+    } ttlMonitor;
+
+    void startTTLBackgroundJob() {
+        ttlMonitor.go();
+    }
+
+    void appendTTLStats( BSONObjBuilder& b ) {
+        ttlMonitor.appendStats( b );
+    }
+
+}
@@ -0,0 +1,39 @@
+// ttl.h
+
+/**
+*    Copyright (C) 2011 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "jsobj.h"
+
+namespace mongo {
+
+    /**
+     * TTL collections
+     *
+     * an index created with { expireAfterSeconds : n } on a single date field
+     * makes documents expire n seconds after that date.  a background job
+     * periodically walks each such index from its oldest key and removes the
+     * expired documents in small batches, dropping the write lock between them.
+     */
+
+    void startTTLBackgroundJob();
+
+    /** per pass counts and timings of the expiry job, for serverStatus */
+    void appendTTLStats( BSONObjBuilder& b );
+
+}
@@ -19,19 +19,14 @@
 #include "pch.h"
 #include "dbtests.h"
 
-// TODO SERVER-1822
-//#include "../s/config.h" // for ShardFields
-//#include "../s/balancer_policy.h"
+#include "../s/config.h" // for ShardFields
+#include "../s/balancer_policy.h"
 
 namespace BalancerPolicyTests {
 
-//
-// TODO SERVER-1822
-//
-#if 0
-
     typedef mongo::ShardFields sf;  // fields from 'shards' colleciton
     typedef mongo::LimitsFields lf; // fields from the balancer's limits map
+    typedef mongo::StatsFields stf; // fields from the balancer's stats map
 
     class SizeMaxedShardTest {
     public:
@@ -179,10 +174,178 @@ namespace BalancerPolicyTests {
         }
     };
 
-//
-// TODO SERVER-1822
-//
-#endif // #if 0
+    //
+    // balanceByCost() and its simulation mode
+    //
+
+    static BSONObj chunk( int min , int max ) {
+        return BSON( "min" << BSON( "x" << min ) << "max" << BSON( "x" << max ) );
+    }
+
+    static BSONObj chunk( int min , int max , long long dataSize ) {
+        return BSON( "min" << BSON( "x" << min ) << "max" << BSON( "x" << max ) << stf::dataSize( dataSize ) );
+    }
+
+    static BSONObj noLimits() {
+        return BSON( sf::maxSize(0LL) << lf::currSize(0LL) << sf::draining(false) << lf::hasOpsQueued(false) );
+    }
+
+    class ChunkCostTest {
+    public:
+        void run() {
+            BSONObj shardStats = BSON( stf::dataSize(1000LL) << stf::opsPerSec(40.0) );
+
+            pair<double,double> even = BalancerPolicy::chunkCost( chunk( 0 , 10 ) , shardStats , 4 );
+            ASSERT_EQUALS( 250.0 , even.first );
+            ASSERT_EQUALS( 10.0 , even.second );
+
+            pair<double,double> own = BalancerPolicy::chunkCost( chunk( 0 , 10 , 700 ) , shardStats , 4 );
+            ASSERT_EQUALS( 700.0 , own.first );
+            ASSERT_EQUALS( 10.0 , own.second );
+
+            pair<double,double> none = BalancerPolicy::chunkCost( chunk( 0 , 10 ) , BSONObj() , 4 );
+            ASSERT_EQUALS( 0.0 , none.first );
+            ASSERT_EQUALS( 0.0 , none.second );
+        }
+    };
+
+    class CostHotShardTest {
+    public:
+        void run() {
+            // same chunks and data on both shards, but shard0 serves most of the ops
+            BalancerPolicy::ShardToChunksMap chunkMap;
+            for ( int i = 0; i < 8; i++ )
+                chunkMap[ i < 4 ? "shard0" : "shard1" ].push_back( chunk( i * 10 , i * 10 + 10 ) );
+
+            BalancerPolicy::ShardToStatsMap statsMap;
+            statsMap["shard0"] = BSON( stf::dataSize(400LL) << stf::opsPerSec(900.0) );
+            statsMap["shard1"] = BSON( stf::dataSize(400LL) << stf::opsPerSec(100.0) );
+
+            BalancerPolicy::ShardToLimitsMap limitsMap;
+            limitsMap["shard0"] = noLimits();
+            limitsMap["shard1"] = noLimits();
+
+            // chunk counts see nothing to do
+            scoped_ptr<BalancerPolicy::ChunkInfo> c( BalancerPolicy::balance( "ns", limitsMap, chunkMap, 0 ) );
+            ASSERT( ! c );
+
+            c.reset( BalancerPolicy::balanceByCost( "ns", limitsMap, chunkMap, statsMap, 0 ) );
+            ASSERT( c );
+            ASSERT_EQUALS( c->from , "shard0" );
+            ASSERT_EQUALS( c->to , "shard1" );
+
+            // one chunk closes most of the gap, a second one would open it the other way
+            ASSERT_EQUALS( 1 , BalancerPolicy::simulate( "ns", limitsMap, chunkMap, statsMap, 10 ) );
+            ASSERT_EQUALS( 3U , chunkMap["shard0"].size() );
+            ASSERT_EQUALS( 5U , chunkMap["shard1"].size() );
+            ASSERT_EQUALS( 675.0 , statsMap["shard0"][ stf::opsPerSec.name() ].number() );
+            ASSERT_EQUALS( 500LL , statsMap["shard1"][ stf::dataSize.name() ].numberLong() );
+
+            map<string,double> loads = BalancerPolicy::shardLoads( chunkMap, statsMap );
+            ASSERT( loads["shard0"] - loads["shard1"] < 0.2 );
+        }
+    };
+
+    class CostBigChunksTest {
+    public:
+        void run() {
+            // shard0 has few chunks but most of the data; the chunks know their own sizes
+            BalancerPolicy::ShardToChunksMap chunkMap;
+            chunkMap["shard0"].push_back( chunk( 0 , 10 , 1000 ) );
+            chunkMap["shard0"].push_back( chunk( 10 , 20 , 100 ) );
+            for ( int i = 2; i < 8; i++ )
+                chunkMap["shard1"].push_back( chunk( i * 10 , i * 10 + 10 , 10 ) );
+
+            BalancerPolicy::ShardToStatsMap statsMap;
+            BalancerPolicy::ShardToLimitsMap limitsMap;
+            limitsMap["shard0"] = noLimits();
+            limitsMap["shard1"] = noLimits();
+
+            // chunk counts would move data the wrong way
+            scoped_ptr<BalancerPolicy::ChunkInfo> c( BalancerPolicy::balance( "ns", limitsMap, chunkMap, 0 ) );
+            ASSERT( c );
+            ASSERT_EQUALS( c->from , "shard1" );
+
+            // the big chunk would only swap which shard is overloaded, so the small one goes
+            c.reset( BalancerPolicy::balanceByCost( "ns", limitsMap, chunkMap, statsMap, 0 ) );
+            ASSERT( c );
+            ASSERT_EQUALS( c->from , "shard0" );
+            ASSERT_EQUALS( 100LL , c->chunk[ stf::dataSize.name() ].numberLong() );
+
+            ASSERT_EQUALS( 1 , BalancerPolicy::simulate( "ns", limitsMap, chunkMap, statsMap, 10 ) );
+            ASSERT_EQUALS( 1U , chunkMap["shard0"].size() );
+            ASSERT_EQUALS( 7U , chunkMap["shard1"].size() );
+
+            // the moved chunk is kept in order
+            ASSERT_EQUALS( 10 , chunkMap["shard1"][0]["min"].Obj()["x"].numberInt() );
+        }
+    };
+
+    class CostDrainingTest {
+    public:
+        void run() {
+            // no stats at all: chunk counts, and shard0 has to be emptied
+            BalancerPolicy::ShardToChunksMap chunkMap;
+            for ( int i = 0; i < 5; i++ )
+                chunkMap[ i < 3 ? "shard0" : ( i < 4 ? "shard1" : "shard2" ) ].push_back( chunk( i * 10 , i * 10 + 10 ) );
+
+            BalancerPolicy::ShardToStatsMap statsMap;
+            BalancerPolicy::ShardToLimitsMap limitsMap;
+            limitsMap["shard0"] = BSON( sf::maxSize(0LL) << lf::currSize(0LL) << sf::draining(true) );
+            limitsMap["shard1"] = noLimits();
+            limitsMap["shard2"] = noLimits();
+
+            ASSERT_EQUALS( 3 , BalancerPolicy::simulate( "ns", limitsMap, chunkMap, statsMap, 10 ) );
+            ASSERT( chunkMap["shard0"].empty() );
+            ASSERT_EQUALS( 5U , chunkMap["shard1"].size() + chunkMap["shard2"].size() );
+            ASSERT( statsMap.empty() );
+        }
+    };
+
+    class CostNoStatsTest {
+    public:
+        void run() {
+            BalancerPolicy::ShardToChunksMap chunkMap;
+            for ( int i = 0; i < 6; i++ )
+                chunkMap[ i < 5 ? "shard0" : "shard1" ].push_back( chunk( i * 10 , i * 10 + 10 ) );
+
+            BalancerPolicy::ShardToStatsMap statsMap;
+            BalancerPolicy::ShardToLimitsMap limitsMap;
+            limitsMap["shard0"] = noLimits();
+            limitsMap["shard1"] = noLimits();
+
+            map<string,double> loads = BalancerPolicy::shardLoads( chunkMap, statsMap );
+            ASSERT_EQUALS( 5.0 / 3 , loads["shard0"] );
+            ASSERT_EQUALS( 1.0 / 3 , loads["shard1"] );
+
+            // the same contiguous chunk balance() would pick
+            scoped_ptr<BalancerPolicy::ChunkInfo> c( BalancerPolicy::balanceByCost( "ns", limitsMap, chunkMap, statsMap, 0 ) );
+            ASSERT( c );
+            ASSERT_EQUALS( 40 , c->chunk["min"].Obj()["x"].numberInt() );
+
+            ASSERT_EQUALS( 2 , BalancerPolicy::simulate( "ns", limitsMap, chunkMap, statsMap, 10 ) );
+            ASSERT_EQUALS( 3U , chunkMap["shard0"].size() );
+            ASSERT_EQUALS( 3U , chunkMap["shard1"].size() );
+        }
+    };
+
+    class CostQueuedOpsTest {
+    public:
+        void run() {
+            // the busiest shard has writebacks pending, so nothing moves
+            BalancerPolicy::ShardToChunksMap chunkMap;
+            chunkMap["shard0"].push_back( chunk( 0 , 10 , 1000 ) );
+            chunkMap["shard0"].push_back( chunk( 10 , 20 , 1000 ) );
+            chunkMap["shard1"] = vector<BSONObj>();
+
+            BalancerPolicy::ShardToStatsMap statsMap;
+            BalancerPolicy::ShardToLimitsMap limitsMap;
+            limitsMap["shard0"] = BSON( sf::maxSize(0LL) << lf::currSize(0LL) << sf::draining(false) << lf::hasOpsQueued(true) );
+            limitsMap["shard1"] = noLimits();
+
+            ASSERT_EQUALS( 0 , BalancerPolicy::simulate( "ns", limitsMap, chunkMap, statsMap, 10 ) );
+        }
+    };
 
     class All : public Suite {
     public:
@@ -190,13 +353,18 @@ namespace BalancerPolicyTests {
         }
 
         void setupTests() {
-            // TODO SERVER-1822
-            // add< SizeMaxedShardTest >();
-            // add< DrainingShardTest >();
-            // add< BalanceNormalTest >();
-            // add< BalanceDrainingTest >();
-            // add< BalanceEndedDrainingTest >();
-            // add< BalanceImpasseTest >();
+            add< SizeMaxedShardTest >();
+            add< DrainingShardTest >();
+            add< BalanceNormalTest >();
+            add< BalanceDrainingTest >();
+            add< BalanceEndedDrainingTest >();
+            add< BalanceImpasseTest >();
+            add< ChunkCostTest >();
+            add< CostHotShardTest >();
+            add< CostBigChunksTest >();
+            add< CostDrainingTest >();
+            add< CostNoStatsTest >();
+            add< CostQueuedOpsTest >();
         }
     } allTests;
 
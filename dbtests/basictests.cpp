@@ -574,6 +574,47 @@ namespace BasicTests {
         }
     };
 
+    class BoundedQueueTest {
+    public:
+        static size_t strSize( const string& s ) { return s.size(); }
+
+        static void pushAll( BlockingQueue<string>* q ) {
+            q->push( "abcd" );
+            q->push( "efgh" );
+            q->push( "ijkl" );
+        }
+
+        void run() {
+            BlockingQueue<string> q( 10 , &strSize );
+            ASSERT_EQUALS( 10u , q.maxSize() );
+
+            // a single element larger than the bound still goes into an empty queue
+            q.push( "0123456789abc" );
+            ASSERT_EQUALS( 13u , q.currentSize() );
+            ASSERT_EQUALS( "0123456789abc" , q.blockingPop() );
+            ASSERT_EQUALS( 0u , q.currentSize() );
+
+            boost::thread pusher( boost::bind( &pushAll , &q ) );
+            sleepmillis( 200 );
+            // the third push has to wait for room
+            ASSERT_EQUALS( 2u , q.size() );
+            ASSERT_EQUALS( 8u , q.currentSize() );
+
+            string s;
+            ASSERT( q.blockingPop( s , 5 ) );
+            ASSERT_EQUALS( "abcd" , s );
+            pusher.join();
+            ASSERT_EQUALS( 2u , q.size() );
+            ASSERT_EQUALS( 8u , q.currentSize() );
+
+            ASSERT( q.tryPop( s ) );
+            ASSERT( q.tryPop( s ) );
+            ASSERT_EQUALS( "ijkl" , s );
+            ASSERT_EQUALS( 0u , q.currentSize() );
+            ASSERT( ! q.tryPop( s ) );
+        }
+    };
+
     class StrTests {
     public:
 
@@ -680,6 +721,7 @@ namespace BasicTests {
             add< IsValidUTF8Test >();
 
             add< QueueTest >();
+            add< BoundedQueueTest >();
 
             add< StrTests >();
 
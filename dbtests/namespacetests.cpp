@@ -1186,6 +1186,32 @@ namespace NamespaceTests {
             }
         };
 
+        class GrowthStats {
+        public:
+            void run() {
+                RecordGrowthStats g;
+                ASSERT_EQUALS( 1.0, g.slackFactor() );
+                // not enough samples yet to have an opinion
+                for( int i = 0; i < RecordGrowthStats::MinSamples - 1; i++ )
+                    g.noteUpdate( 1000, 1100, true );
+                ASSERT_EQUALS( 1.0, g.slackFactor() );
+                g.noteUpdate( 1000, 1100, true );
+                // 10% growth falls in the 1/8 bucket
+                ASSERT_EQUALS( 1.125, g.slackFactor() );
+                ASSERT_EQUALS( 1.0, g.moveRate() );
+                // mostly in place non growing updates
+                for( int i = 0; i < 10 * RecordGrowthStats::MinSamples; i++ )
+                    g.noteUpdate( 1000, 1000, false );
+                ASSERT_EQUALS( 1.0, g.slackFactor() );
+                ASSERT( g.moveRate() < 0.1 );
+                ASSERT_EQUALS( 11LL * RecordGrowthStats::MinSamples, g.updates() );
+                // huge growth is capped
+                for( int i = 0; i < RecordGrowthStats::MaxSamples; i++ )
+                    g.noteUpdate( 100, 1000, true );
+                ASSERT_EQUALS( 2.0, g.slackFactor() );
+            }
+        };
+
     } // namespace NamespaceDetailsTests
 
     class All : public Suite {
@@ -1238,6 +1264,7 @@ namespace NamespaceTests {
             add< NamespaceDetailsTests::Migrate >();
             //            add< NamespaceDetailsTests::BigCollection >();
             add< NamespaceDetailsTests::Size >();
+            add< NamespaceDetailsTests::GrowthStats >();
         }
     } myall;
 } // namespace NamespaceTests
@@ -1103,6 +1103,66 @@ namespace ReplTests {
         }
     };
 
+    /** Check OplogStartIndex lookups and pruning of overwritten entries */
+    class OplogStartIndexFind : public Base {
+    public:
+        void run() {
+            for( int i = 0; i < 10; ++i ) {
+                client()->insert( ns(), BSON( "_id" << i ) );
+            }
+            dblock lk;
+            Client::Context ctx( cllNS() );
+            NamespaceDetails *nsd = nsdetails( cllNS() );
+            vector<OpTime> ts;
+            vector<DiskLoc> locs;
+            for( boost::shared_ptr<Cursor> c = theDataFileMgr.findAll( cllNS() ); c->ok(); c->advance() ) {
+                ts.push_back( c->current()[ "ts" ]._opTime() );
+                locs.push_back( c->currLoc() );
+            }
+            int n = ts.size();
+            ASSERT( n >= 10 );
+
+            OplogStartIndex idx;
+            idx.inserted( ts[ n - 8 ], locs[ n - 8 ], OplogStartIndex::SampleBytes );
+            idx.inserted( ts[ n - 4 ], locs[ n - 4 ], OplogStartIndex::SampleBytes );
+            ASSERT( locs[ n - 8 ] == idx.find( nsd, ts[ n - 5 ], ts[ 0 ] ) );
+            ASSERT( locs[ n - 4 ] == idx.find( nsd, ts[ n - 4 ], ts[ 0 ] ) );
+            ASSERT( locs[ n - 4 ] == idx.find( nsd, ts[ n - 1 ], ts[ 0 ] ) );
+            // the first record of the extent is seeded
+            ASSERT( locs[ 0 ] == idx.find( nsd, ts[ 0 ], ts[ 0 ] ) );
+            // everything before ts[ n - 2 ] has been overwritten
+            ASSERT( idx.find( nsd, ts[ n - 2 ], ts[ n - 2 ] ).isNull() );
+            ASSERT_EQUALS( 0U, idx.size() );
+        }
+    };
+
+    /** Check FindingStartCursor starts right at the first matching op */
+    class FindingStartCursorIndexed : public Base {
+    public:
+        void run() {
+            for( int i = 0; i < 10; ++i ) {
+                client()->insert( ns(), BSON( "_id" << i ) );
+            }
+            BSONObj sixth = client()->findOne( cllNS(), QUERY( "o._id" << 6 ) );
+            dblock lk;
+            Client::Context ctx( cllNS() );
+            NamespaceDetails *nsd = nsdetails( cllNS() );
+            BSONObjBuilder b;
+            b.appendAs( sixth[ "ts" ], "$gte" );
+            BSONObj query = BSON( "ts" << b.obj() );
+            FieldRangeSetPair frsp( cllNS(), query );
+            BSONObj order = BSON( "$natural" << 1 );
+            QueryPlan qp( nsd, -1, frsp, &frsp, query, order );
+            FindingStartCursor fsc( qp );
+            // at most one op between the indexed start and the match
+            for( int i = 0; i < 10 && !fsc.done(); ++i ) {
+                fsc.next();
+            }
+            ASSERT( fsc.done() );
+            ASSERT_EQUALS( 6, fsc.cursor()->current()[ "o" ].Obj()[ "_id" ].Int() );
+        }
+    };
+
     /** Check ReplSetConfig::MemberCfg equality */
     class ReplSetMemberCfgEquality : public Base {
     public:
@@ -1219,6 +1279,8 @@ namespace ReplTests {
             add< DatabaseIgnorerUpdate >();
             add< FindingStartCursorStale >();
             add< FindingStartCursorYield >();
+            add< OplogStartIndexFind >();
+            add< FindingStartCursorIndexed >();
             add< ReplSetMemberCfgEquality >();
             add< ShouldRetry >();
         }
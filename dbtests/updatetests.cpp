@@ -491,6 +491,31 @@ namespace UpdateTests {
         }
     };
 
+    /** multi update with index changes applied in key order batches */
+    class IndexModSetBatched : public SetBase {
+    public:
+        IndexModSetBatched() : _old( multiUpdateIndexBatchSize ) {
+            multiUpdateIndexBatchSize = 7;
+        }
+        ~IndexModSetBatched() {
+            multiUpdateIndexBatchSize = _old;
+        }
+        void run() {
+            client().ensureIndex( ns(), BSON( "a" << 1 ) );
+            client().ensureIndex( ns(), BSON( "b" << 1 ) );
+            for( int i = 0; i < 100; i++ )
+                client().insert( ns(), BSON( "_id" << i << "a" << ( i * 37 ) % 100 << "b" << i ) );
+            client().update( ns(), BSON( "b" << GTE << 0 ), fromjson( "{$inc:{a:1000}}" ), false, true );
+            ASSERT_EQUALS( 0U, client().count( ns(), BSON( "a" << LT << 1000 ) ) );
+            ASSERT_EQUALS( 100U, client().count( ns(), BSON( "a" << GTE << 1000 ) ) );
+            for( int i = 0; i < 100; i += 10 ) {
+                BSONObj o = client().findOne( ns(), QUERY( "a" << 1000 + ( i * 37 ) % 100 ).hint( BSON( "a" << 1 ) ) );
+                ASSERT_EQUALS( i, o["_id"].numberInt() );
+            }
+        }
+    private:
+        unsigned _old;
+    };
 
     class PreserveIdWithIndex : public SetBase { // Not using $set, but base class is still useful
     public:
@@ -598,6 +623,40 @@ namespace UpdateTests {
             }
         };
 
+        class replacementDelta1 {
+        public:
+            void run() {
+                string big( 2000 , 'x' );
+                BSONObj from = BSON( "_id" << 1 << "a" << 1 << "big" << big << "c" << "str" );
+
+                // a value changes in place
+                ASSERT_EQUALS( BSON( "$set" << BSON( "a" << 2 ) ) ,
+                               replacementDelta( from , BSON( "_id" << 1 << "a" << 2 << "big" << big << "c" << "str" ) ) );
+
+                // the replacement has no _id, updateRecord keeps the old one
+                ASSERT_EQUALS( BSON( "$set" << BSON( "c" << "rts!" ) ) ,
+                               replacementDelta( from , BSON( "a" << 1 << "big" << big << "c" << "rts!" ) ) );
+
+                // a field added and one removed, rebuilt in field name order
+                ASSERT_EQUALS( BSON( "$set" << BSON( "b" << 5 ) << "$unset" << BSON( "c" << 1 ) ) ,
+                               replacementDelta( from , BSON( "_id" << 1 << "a" << 1 << "b" << 5 << "big" << big ) ) );
+
+                // the mods would put the fields in a different order
+                ASSERT( replacementDelta( from , BSON( "_id" << 1 << "a" << 1 << "big" << big << "c" << "str" << "b" << 5 ) ).isEmpty() );
+                ASSERT( replacementDelta( from , BSON( "_id" << 1 << "big" << big << "a" << 1 << "c" << "s" ) ).isEmpty() );
+                // same fields, same sizes, a different order: in place the $set would keep the old order
+                ASSERT( replacementDelta( from , BSON( "_id" << 1 << "big" << big << "a" << 2 << "c" << "str" ) ).isEmpty() );
+
+                // nothing changed, too small to bother, or no smaller than the document
+                ASSERT( replacementDelta( from , from ).isEmpty() );
+                ASSERT( replacementDelta( BSON( "_id" << 1 << "a" << 1 ) , BSON( "_id" << 1 << "a" << 2 ) ).isEmpty() );
+                ASSERT( replacementDelta( from , BSON( "_id" << 1 << "big" << string( 2000 , 'y' ) ) ).isEmpty() );
+
+                // names a $set can't address
+                ASSERT( replacementDelta( from , BSON( "_id" << 1 << "a" << 1 << "big" << big << "c" << "str" << "x.y" << 1 ) ).isEmpty() );
+            }
+        };
+
     };
 
     namespace basic {
@@ -851,6 +910,7 @@ namespace UpdateTests {
             add< InsertInEmpty >();
             add< IndexParentOfMod >();
             add< IndexModSet >();
+            add< IndexModSetBatched >();
             add< PreserveIdWithIndex >();
             add< CheckNoMods >();
             add< UpdateMissingToNull >();
@@ -860,6 +920,7 @@ namespace UpdateTests {
             add< ModSetTests::inc2 >();
             add< ModSetTests::set1 >();
             add< ModSetTests::push1 >();
+            add< ModSetTests::replacementDelta1 >();
 
             add< basic::inc1 >();
             add< basic::inc2 >();
@@ -0,0 +1,34 @@
+// benchRun with pipelined acknowledged inserts (writeack)
+
+t = db.bench_test3
+t.drop();
+
+seconds = 1
+
+res = benchRun( { ops : [ { ns : t.getFullName() ,
+                            op : "insert" ,
+                            doc : { y : { "#RAND_INT" : [ 0 , 1000 ] } } ,
+                            pipeline : 16 } ] ,
+                  parallel : 2 ,
+                  seconds : seconds ,
+                  totals : true ,
+                  host : db.getMongo().host } )
+printjson( res );
+
+assert.lt( 0 , res.insert , "A1" )
+assert.lte( res.insert , t.count() , "A2" )
+
+// acknowledgements carry the write's error
+t.drop();
+t.ensureIndex( { z : 1 } , { unique : true } );
+
+benchRun( { ops : [ { ns : t.getFullName() ,
+                      op : "insert" ,
+                      doc : { z : 1 } ,
+                      pipeline : 4 ,
+                      throwGLE : true } ] ,
+            parallel : 1 ,
+            seconds : seconds ,
+            host : db.getMongo().host } )
+
+assert.eq( 1 , t.count() , "B1" )
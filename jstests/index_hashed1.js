@@ -0,0 +1,80 @@
+// hashed indexes: { a : "hashed" } answers equality and $in queries
+
+t = db.index_hashed1;
+t.drop();
+
+for ( var i = 0; i < 100; i++ )
+    t.insert( { _id : i , a : i % 10 , s : "str" + ( i % 10 ) } );
+t.insert( { _id : 100 , a : { x : 1 , y : [ 1 , 2 ] } } );
+t.insert( { _id : 101 } );
+
+t.ensureIndex( { a : "hashed" } );
+assert.isnull( db.getLastError() , "A1" );
+assert.eq( 2 , t.getIndexes().length , "A2" );
+
+function check( q , n , cursor , msg ) {
+    assert.eq( n , t.find( q ).itcount() , msg + " itcount" );
+    assert.eq( n , t.find( q ).count() , msg + " count" );
+    if ( cursor )
+        assert.eq( cursor , t.find( q ).explain().cursor , msg + " explain" );
+}
+
+check( { a : 3 } , 10 , "BtreeCursor a_hashed" , "B1" );
+check( { a : 3.0 } , 10 , "BtreeCursor a_hashed" , "B2" );
+check( { a : NumberLong( 3 ) } , 10 , "BtreeCursor a_hashed" , "B3" );
+check( { a : 42 } , 0 , "BtreeCursor a_hashed" , "B4" );
+check( { a : "3" } , 0 , "BtreeCursor a_hashed" , "B5" );
+check( { a : { x : 1 , y : [ 1 , 2 ] } } , 1 , "BtreeCursor a_hashed" , "B6" );
+check( { a : { y : [ 1 , 2 ] , x : 1 } } , 0 , null , "B7" );
+check( { a : null } , 1 , "BtreeCursor a_hashed" , "B8" );
+
+check( { a : { $in : [ 1 , 2 , 42 ] } } , 20 , "BtreeCursor a_hashed multi" , "C1" );
+check( { a : { $in : [] } } , 0 , null , "C2" );
+check( { a : 3 , s : "str4" } , 0 , null , "C3" );
+check( { a : 3 , s : "str3" } , 10 , null , "C4" );
+
+// ranges can't use the hash order
+check( { a : { $gt : 7 } } , 20 , "BasicCursor" , "D1" );
+check( { a : { $lte : 1 } } , 20 , "BasicCursor" , "D2" );
+check( { a : /3/ } , 0 , "BasicCursor" , "D3" );
+
+// the key is the hash, never return it as the value
+assert.eq( 3 , t.findOne( { a : 3 } , { _id : 0 , a : 1 } ).a , "E1" );
+
+// sorting needs an in memory sort
+assert.eq( [ 1 , 1 , 2 ] , t.find( { a : { $in : [ 2 , 1 ] } } ).sort( { a : 1 } ).limit( 3 ).toArray().map( function( z ) { return z.a; } ) , "F1" );
+
+// updates keep the index in sync
+t.update( { a : 3 } , { $set : { a : 33 } } , false , true );
+check( { a : 3 } , 0 , "BtreeCursor a_hashed" , "G1" );
+check( { a : 33 } , 10 , "BtreeCursor a_hashed" , "G2" );
+
+// arrays can't be hashed
+t.insert( { _id : 200 , a : [ 1 , 2 ] } );
+assert( db.getLastError() , "H1" );
+assert.eq( 0 , t.find( { _id : 200 } ).itcount() , "H2" );
+
+// no compound or unique hashed indexes
+t.ensureIndex( { s : "hashed" , _id : 1 } );
+assert( db.getLastError() , "I1" );
+t.ensureIndex( { s : "hashed" } , { unique : true } );
+assert( db.getLastError() , "I2" );
+assert.eq( 2 , t.getIndexes().length , "I3" );
+
+assert( t.validate().valid , "J1" );
+
+// dotted fields may go through an array to a single value, not to several
+u = db.index_hashed1_dotted;
+u.drop();
+u.ensureIndex( { "a.b" : "hashed" } );
+u.insert( { _id : 1 , a : [ { b : 1 } ] } );
+u.insert( { _id : 2 , a : { b : 1 } } );
+u.insert( { _id : 3 , a : [ { c : 1 } ] } );
+assert.isnull( db.getLastError() , "K1" );
+assert.eq( 2 , u.find( { "a.b" : 1 } ).itcount() , "K2" );
+assert.eq( "BtreeCursor a.b_hashed" , u.find( { "a.b" : 1 } ).explain().cursor , "K3" );
+assert.eq( 1 , u.find( { "a.b" : null } ).itcount() , "K4" );
+u.insert( { _id : 4 , a : [ { b : 1 } , { b : 2 } ] } );
+assert( db.getLastError() , "K5" );
+assert.eq( 0 , u.find( { _id : 4 } ).itcount() , "K6" );
+assert( u.validate().valid , "K7" );
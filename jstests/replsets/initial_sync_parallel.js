@@ -0,0 +1,59 @@
+// initial sync clones collections concurrently and reports its progress per collection
+
+var replTest = new ReplSetTest( { name : 'initialSyncParallel' , nodes : 1 } );
+replTest.startSet();
+replTest.initiate();
+
+var master = replTest.getMaster();
+
+var colls = 0;
+for ( var d = 0; d < 3; d++ ) {
+    var mdb = master.getDB( "isp" + d );
+    for ( var c = 0; c < 4; c++ ) {
+        var t = mdb[ "c" + c ];
+        for ( var i = 0; i < 500; i++ )
+            t.insert( { _id : i , x : i % 7 , s : "doc " + i } );
+        t.ensureIndex( { x : 1 } );
+        colls++;
+    }
+    mdb.getLastError();
+}
+master.getDB( "isp0" ).createCollection( "capped" , { capped : true , size : 100000 } );
+master.getDB( "isp0" ).capped.insert( { a : 1 } );
+master.getDB( "isp0" ).getLastError();
+colls++;
+
+var slave = replTest.add();
+replTest.reInitiate();
+replTest.awaitSecondaryNodes();
+replTest.awaitReplication();
+
+slave.setSlaveOk();
+for ( var d = 0; d < 3; d++ ) {
+    var sdb = slave.getDB( "isp" + d );
+    for ( var c = 0; c < 4; c++ ) {
+        var t = sdb[ "c" + c ];
+        assert.eq( 500 , t.count() , "A1 " + t );
+        assert.eq( 2 , t.getIndexes().length , "A2 " + t );
+        assert.eq( "BtreeCursor x_1" , t.find( { x : 3 } ).explain().cursor , "A3 " + t );
+    }
+}
+assert( slave.getDB( "isp0" ).capped.isCapped() , "A4" );
+
+var status = slave.getDB( "admin" ).runCommand( { replSetGetStatus : 1 } );
+printjson( status.initialSync );
+var is = status.initialSync;
+assert( is , "B1" );
+assert.eq( 4 , is.threads , "B2" );
+// every collection above, plus any system collections that are cloned too
+assert.lte( colls , is.collections , "B3" );
+assert.eq( is.collections , is.collectionsCloned , "B4" );
+assert.lte( 6001 , is.docs , "B5" );
+assert.eq( 0 , is.cloning.length , "B6" );
+
+var admin = slave.getDB( "admin" );
+assert.eq( 4 , admin.runCommand( { getParameter : 1 , replInitialSyncCloneThreads : 1 } ).replInitialSyncCloneThreads , "C1" );
+assert.commandWorked( admin.runCommand( { setParameter : 1 , replInitialSyncCloneThreads : 8 } ) , "C2" );
+assert.commandFailed( admin.runCommand( { setParameter : 1 , replInitialSyncCloneThreads : 0 } ) , "C3" );
+
+replTest.stopSet();
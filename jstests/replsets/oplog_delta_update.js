@@ -0,0 +1,39 @@
+// replacing a large document logs only the fields that changed
+
+var replTest = new ReplSetTest( { name : 'oplogDeltaUpdate' , nodes : 2 } );
+replTest.startSet();
+replTest.initiate();
+
+var master = replTest.getMaster();
+var t = master.getDB( "odu" ).foo;
+var oplog = master.getDB( "local" ).oplog.rs;
+
+var big = new Array( 5000 ).join( "x" );
+t.insert( { _id : 1 , a : 1 , big : big , c : "str" } );
+t.insert( { _id : 2 , a : 1 , big : big , c : "str" } );
+master.getDB( "odu" ).getLastError();
+
+function lastUpdate() {
+    return oplog.find( { ns : "odu.foo" , op : "u" } ).sort( { $natural : -1 } ).limit( 1 ).next();
+}
+
+// a value changed
+t.update( { _id : 1 } , { _id : 1 , a : 2 , big : big , c : "str" } );
+assert.eq( { $set : { a : 2 } } , lastUpdate().o , "A1" );
+
+// a field added and one removed, the replacement without _id
+t.update( { _id : 1 } , { a : 2 , b : 5 , big : big } );
+assert.eq( { $set : { b : 5 } , $unset : { c : 1 } } , lastUpdate().o , "A2" );
+
+// fields the mods would reorder are logged whole
+t.update( { _id : 2 } , { _id : 2 , big : big , a : 1 , c : "s" } );
+assert.eq( big , lastUpdate().o.big , "B1" );
+
+replTest.awaitReplication();
+var slave = replTest.liveNodes.slaves[0];
+slave.setSlaveOk();
+var s = slave.getDB( "odu" ).foo;
+assert.eq( tojson( t.findOne( { _id : 1 } ) ) , tojson( s.findOne( { _id : 1 } ) ) , "C1" );
+assert.eq( tojson( t.findOne( { _id : 2 } ) ) , tojson( s.findOne( { _id : 2 } ) ) , "C2" );
+
+replTest.stopSet();
@@ -0,0 +1,42 @@
+// a batch insert writes its oplog entries as a group; they must replicate like single inserts
+
+var replTest = new ReplSetTest( { name : 'oplogGroupInsert' , nodes : 2 } );
+var nodes = replTest.startSet();
+replTest.initiate();
+
+var master = replTest.getMaster();
+var mdb = master.getDB( "ogi" );
+
+var docs = [];
+for ( var i = 0; i < 2500; i++ )
+    docs.push( { _id : i , x : "doc " + i } );
+mdb.foo.insert( docs );
+assert.isnull( mdb.getLastError() , "A1" );
+assert.eq( 2500 , mdb.foo.count() , "A2" );
+
+// one entry per document, in insert order, with increasing optimes
+var oplog = master.getDB( "local" ).oplog.rs;
+var ops = oplog.find( { ns : "ogi.foo" , op : "i" } ).sort( { $natural : 1 } ).toArray();
+assert.eq( 2500 , ops.length , "B1" );
+for ( var i = 0; i < ops.length; i++ ) {
+    assert.eq( i , ops[i].o._id , "B2 " + i );
+    if ( i > 0 ) {
+        assert( ops[i].ts > ops[i-1].ts , "B3 " + i );
+        assert.neq( ops[i].h , ops[i-1].h , "B4 " + i );
+    }
+}
+
+// a failure part way logs the documents inserted before it and nothing after
+mdb.foo.insert( [ { _id : 3000 } , { _id : 5 } , { _id : 3001 } ] );
+assert( mdb.getLastError() , "C1" );
+assert.eq( 1 , oplog.find( { ns : "ogi.foo" , "o._id" : 3000 } ).itcount() , "C2" );
+assert.eq( 0 , oplog.find( { ns : "ogi.foo" , "o._id" : 3001 } ).itcount() , "C3" );
+
+replTest.awaitReplication();
+var slave = replTest.liveNodes.slaves[0];
+slave.setSlaveOk();
+assert.eq( 2501 , slave.getDB( "ogi" ).foo.count() , "D1" );
+assert.eq( 1 , slave.getDB( "ogi" ).foo.find( { _id : 3000 } ).itcount() , "D2" );
+assert.eq( 0 , slave.getDB( "ogi" ).foo.find( { _id : 3001 } ).itcount() , "D3" );
+
+replTest.stopSet();
@@ -225,6 +225,16 @@ doTest = function (signal) {
 
     assert( dbs_match(a,b), "server data sets do not match after rollback, something is wrong");
 
+    // B reports what its rollback did; refetches go one query per namespace, not one per document
+    var rb = B.runCommand({ replSetGetStatus: 1 }).rollback;
+    printjson(rb);
+    assert(rb && rb.rollbacks >= 1, "rollback stats missing");
+    assert.eq("done", rb.last.result, "rollback result");
+    assert(rb.last.docs >= 7, "rollback docs");
+    assert(rb.last.refetchQueries >= 1 && rb.last.refetchQueries < rb.last.docs, "rollback refetch queries");
+    assert(rb.last.phaseMillis.findCommonPoint != null && rb.last.phaseMillis.refetch != null &&
+           rb.last.phaseMillis.apply != null && rb.last.phaseMillis.truncateOplog != null, "rollback phases");
+
     pause("rollback2.js SUCCESS");
     replTest.stopSet(signal);
 };
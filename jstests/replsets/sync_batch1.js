@@ -0,0 +1,60 @@
+// secondaries apply the oplog in batches and report it in replSetGetStatus
+
+var replTest = new ReplSetTest( { name : 'syncBatch1' , nodes : 2 , oplogSize : 20 } );
+var nodes = replTest.startSet();
+replTest.initiate();
+
+var master = replTest.getMaster();
+var mdb = master.getDB( "test" );
+
+for ( var i = 0; i < 5000; i++ ) {
+    mdb.foo.insert( { _id : i , x : i } );
+}
+mdb.foo.update( {} , { $inc : { x : 1 } } , false , true );
+mdb.foo.remove( { _id : { $lt : 100 } } );
+mdb.getLastError();
+
+replTest.awaitReplication();
+
+var slave = replTest.liveNodes.slaves[ 0 ];
+slave.setSlaveOk();
+var sdb = slave.getDB( "test" );
+assert.eq( 4900 , sdb.foo.count() , "A1" );
+assert.eq( 101 , sdb.foo.findOne( { _id : 100 } ).x , "A2" );
+assert.eq( 5000 , sdb.foo.findOne( { _id : 4999 } ).x , "A3" );
+
+var status = slave.getDB( "admin" ).runCommand( { replSetGetStatus : 1 } );
+printjson( status.syncApply );
+assert( status.syncApply , "B1" );
+assert( status.syncApply.ops >= 10000 , "B2" );
+assert( status.syncApply.batches < status.syncApply.ops , "B3" );
+assert( status.syncApply.lastBatch.ops <= 1000 , "B4" );
+assert( status.syncApply.lagSecs <= 1 , "B5" );
+
+// prefetching ran ahead of the applier: one _id lookup per update/remove plus the index keys
+var pf = status.syncApply.prefetch;
+assert.eq( 4 , pf.threads , "C1" );
+assert( pf.ops >= 10000 , "C2" );
+assert( pf.records >= 5000 , "C3" );
+assert( pf.indexKeys >= pf.ops , "C4" );
+
+var admin = slave.getDB( "admin" );
+assert.commandWorked( admin.runCommand( { setParameter : 1 , replPrefetchThreads : 0 } ) , "D1" );
+assert.commandFailed( admin.runCommand( { setParameter : 1 , replPrefetchThreads : 100 } ) , "D2" );
+mdb.foo.insert( { _id : "after" } );
+mdb.getLastError();
+replTest.awaitReplication();
+assert.eq( pf.ops , admin.runCommand( { replSetGetStatus : 1 } ).syncApply.prefetch.ops , "D3" );
+
+// the fetcher read everything ahead of the applier and its buffer drained
+var fe = admin.runCommand( { replSetGetStatus : 1 } ).syncApply.fetcher;
+printjson( fe );
+assert( fe.ops >= 10001 , "E1" );
+assert( fe.bytes > 0 , "E2" );
+assert.eq( 64 * 1024 * 1024 , fe.buffer.maxBytes , "E3" );
+assert.eq( 0 , fe.buffer.ops , "E4" );
+assert.eq( 0 , fe.buffer.bytes , "E5" );
+
+assert.isnull( master.getDB( "admin" ).runCommand( { replSetGetStatus : 1 } ).syncApply , "F1" );
+
+replTest.stopSet();
@@ -0,0 +1,35 @@
+// secondaries report the member they sync from, picked by ping time, and its lag
+
+var replTest = new ReplSetTest( { name : 'syncSource1' , nodes : 3 } );
+var nodes = replTest.startSet();
+replTest.initiate();
+
+var master = replTest.getMaster();
+for ( var i = 0; i < 100; i++ )
+    master.getDB( "ss" ).foo.insert( { _id : i } );
+master.getDB( "ss" ).getLastError();
+replTest.awaitReplication();
+
+var hosts = replTest.nodeList();
+nodes.forEach( function( n ) {
+    if ( n == master )
+        return;
+    var status;
+    assert.soon( function() {
+        status = n.getDB( "admin" ).runCommand( { replSetGetStatus : 1 } );
+        return status.syncSource != null;
+    } , "no sync source on " + n );
+    printjson( status.syncSource );
+    assert.eq( status.syncingTo , status.syncSource.host , "A1" );
+    assert.neq( -1 , hosts.indexOf( status.syncSource.host ) , "A2" );
+    assert( status.syncSource.state == 1 || status.syncSource.state == 2 , "A3" );
+    assert( status.syncSource.pingMs >= 0 , "A4" );
+    assert( status.syncSource.lagSecs != null , "A5" );
+} );
+
+var admin = master.getDB( "admin" );
+assert.eq( 30 , admin.runCommand( { getParameter : 1 , replMaxSyncSourceLagSecs : 1 } ).replMaxSyncSourceLagSecs , "B1" );
+assert.commandWorked( admin.runCommand( { setParameter : 1 , replMaxSyncSourceLagSecs : 0 } ) , "B2" );
+assert.commandFailed( admin.runCommand( { setParameter : 1 , replMaxSyncSourceLagSecs : -1 } ) , "B3" );
+
+replTest.stopSet();
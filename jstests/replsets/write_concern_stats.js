@@ -0,0 +1,37 @@
+// getLastError w waits are woken by slave progress and counted in serverStatus
+
+var replTest = new ReplSetTest( { name : 'writeConcernStats' , nodes : 3 } );
+replTest.startSet();
+replTest.initiate();
+
+var master = replTest.getMaster();
+var mdb = master.getDB( "wcs" );
+replTest.awaitReplication();
+
+var before = master.getDB( "admin" ).serverStatus().writeConcern;
+assert( before , "A1" );
+
+for ( var i = 0; i < 20; i++ ) {
+    mdb.foo.insert( { _id : i } );
+    var res = mdb.runCommand( { getlasterror : 1 , w : "majority" , wtimeout : 30000 } );
+    assert.isnull( res.err , "B1 " + tojson( res ) );
+}
+var res = mdb.runCommand( { getlasterror : 1 , w : 3 , wtimeout : 30000 } );
+assert.isnull( res.err , "B2 " + tojson( res ) );
+
+var after = master.getDB( "admin" ).serverStatus().writeConcern;
+printjson( after );
+assert.eq( before.waits + 21 , after.waits , "C1" );
+assert.eq( before.majority.waits + 20 , after.majority.waits , "C2" );
+assert.eq( 16 , after.majority.histogramMillis.length , "C3" );
+var n = 0;
+after.majority.histogramMillis.forEach( function( b ) { n += b.count; } );
+assert.eq( after.majority.waits , n , "C4" );
+
+// w can't be met: times out and is counted as such
+mdb.foo.insert( { _id : "x" } );
+res = mdb.runCommand( { getlasterror : 1 , w : 4 , wtimeout : 500 } );
+assert.eq( "timeout" , res.err , "D1" );
+assert.eq( after.timeouts + 1 , master.getDB( "admin" ).serverStatus().writeConcern.timeouts , "D2" );
+
+replTest.stopSet();
@@ -0,0 +1,55 @@
+// autosplit_shard.js
+// the shard counts writes from every mongos against its chunks and splits the full ones itself
+
+s = new ShardingTest( "autosplit_shard" , 2 , 1 , 2 , { chunksize : 1 } );
+s.stopBalancer();
+s2 = s._mongos[1];
+
+s.adminCommand( { enablesharding : "test" } );
+s.adminCommand( { shardcollection : "test.foo" , key : { num : 1 } } );
+assert.commandWorked( s.adminCommand( { split : "test.foo" , middle : { num : 0 } } ) , "A1" );
+assert.commandWorked( s.adminCommand( { split : "test.foo" , middle : { num : 1000000 } } ) , "A2" );
+
+var primary = s.getServer( "test" );
+function autoSplit() {
+    var res = primary.getDB( "admin" ).runCommand( { shardingState : 1 } );
+    printjson( res.autoSplit );
+    return res.autoSplit;
+}
+
+var big = "";
+while ( big.length < 10000 )
+    big += "x";
+
+// each mongos alone writes less than a fifth of the chunk size to the middle chunk, together they don't
+var dbs = [ s.getDB( "test" ) , s2.getDB( "test" ) ];
+for ( var i = 0; i < 300; i++ )
+    dbs[ i % 2 ].foo.insert( { num : i * 10 , s : big } );
+dbs.forEach( function( z ) { assert.isnull( z.getLastError() , "B1" ); } );
+
+assert.soon( function() {
+    return s.config.chunks.count( { ns : "test.foo" } ) > 3;
+} , "B2 middle chunk never split" , 60 * 1000 );
+assert.lt( 0 , autoSplit().splits , "B3" );
+
+var log = s.config.changelog.findOne( { what : "split" , ns : "test.foo" , "details.before.min.num" : 0 } );
+printjson( log );
+assert( log , "B4" );
+
+// every document is still found through either mongos, which hadn't seen the split
+assert.eq( 300 , s.getDB( "test" ).foo.find().itcount() , "C1" );
+assert.eq( 300 , s2.getDB( "test" ).foo.find().itcount() , "C2" );
+assert.eq( 1 , s2.getDB( "test" ).foo.find( { num : 2990 } ).itcount() , "C3" );
+
+// updates by shard key count too, on a chunk that only gets updates
+for ( var i = 0; i < 10; i++ )
+    s.getDB( "test" ).foo.insert( { num : 2000000 + i , s : "" } );
+s.getDB( "test" ).getLastError();
+var before = autoSplit().checks;
+for ( var j = 0; j < 30; j++ )
+    for ( var i = 0; i < 10; i++ )
+        dbs[ j % 2 ].foo.update( { num : 2000000 + i } , { $set : { s : big + j } } );
+dbs.forEach( function( z ) { assert.isnull( z.getLastError() , "D1" ); } );
+assert.soon( function() { return autoSplit().checks > before; } , "D2" , 60 * 1000 );
+
+s.stop();
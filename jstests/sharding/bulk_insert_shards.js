@@ -0,0 +1,55 @@
+// bulk_insert_shards.js
+// a bulk insert through mongos goes out as one batch per shard, and is routed again after a migration it didn't see
+
+s = new ShardingTest( "bulk_insert_shards" , 2 , 1 , 2 );
+s.stopBalancer();
+s2 = s._mongos[1];
+
+s.adminCommand( { enablesharding : "test" } );
+s.adminCommand( { shardcollection : "test.foo" , key : { num : 1 } } );
+
+db = s.getDB( "test" );
+
+for ( var i = 100; i < 1000; i += 100 )
+    assert.commandWorked( s.adminCommand( { split : "test.foo" , middle : { num : i } } ) , "A1 " + i );
+
+var primary = s.getServer( "test" );
+var other = s.getOther( primary );
+for ( var i = 500; i < 1000; i += 100 )
+    assert.commandWorked( s.adminCommand( { movechunk : "test.foo" , find : { num : i } , to : other.name } ) , "A2 " + i );
+
+function bulk( from , to ) {
+    var docs = [];
+    for ( var i = from; i < to; i++ )
+        docs.push( { num : i , s : "doc " + i } );
+    return docs;
+}
+
+// ten chunks over two shards
+db.foo.insert( bulk( 0 , 1000 ) );
+assert.isnull( db.getLastError() , "B1" );
+assert.eq( 1000 , db.foo.count() , "B2" );
+assert.eq( 500 , primary.getDB( "test" ).foo.count() , "B3" );
+assert.eq( 500 , other.getDB( "test" ).foo.count() , "B4" );
+
+// errors from either shard come back through getLastError
+db.foo.ensureIndex( { s : 1 } , { unique : true } );
+db.foo.insert( [ { num : 1001 , s : "doc 10" } , { num : 1002 , s : "x" } , { num : 2 , s : "doc 900" } ] );
+var gle = db.getLastErrorObj();
+printjson( gle );
+assert( gle.err , "C1" );
+assert.eq( 1 , db.foo.count( { num : 1002 } ) , "C2" );
+
+// the second mongos hasn't seen these chunks move back
+s2.getDB( "test" ).foo.findOne();
+for ( var i = 500; i < 1000; i += 100 )
+    assert.commandWorked( s.adminCommand( { movechunk : "test.foo" , find : { num : i } , to : primary.name } ) , "D1 " + i );
+assert.commandWorked( s.adminCommand( { movechunk : "test.foo" , find : { num : 0 } , to : other.name } ) , "D2" );
+
+s2.getDB( "test" ).foo.insert( bulk( 2000 , 2100 ).concat( [ { num : 1500 , s : "y" } , { num : 50 , s : "z" } ] ) );
+assert.isnull( s2.getDB( "test" ).getLastError() , "D3" );
+assert.eq( 1 , other.getDB( "test" ).foo.count( { num : 50 } ) , "D4" );
+assert.eq( 1 , primary.getDB( "test" ).foo.count( { num : 1500 } ) , "D5" );
+assert.eq( 1103 , db.foo.count() , "D6" );
+
+s.stop();
@@ -0,0 +1,55 @@
+// chunk_reload.js
+// a mongos that already knows a collection's chunks only reads the ones that changed
+
+s = new ShardingTest( "chunk_reload" , 2 , 1 , 2 );
+s2 = s._mongos[1];
+
+s.adminCommand( { enablesharding : "test" } );
+s.adminCommand( { shardcollection : "test.foo" , key : { num : 1 } } );
+
+db = s.getDB( "test" );
+for ( var i = 0; i < 100; i++ )
+    db.foo.insert( { num : i } );
+db.getLastError();
+
+// both mongos know about the collection now
+assert.eq( 100 , db.foo.count() , "A1" );
+assert.eq( 100 , s2.getDB( "test" ).foo.count() , "A2" );
+
+function loads( m ) {
+    var res = m.getDB( "admin" ).runCommand( { serverStatus : 1 } ).chunkManagerLoads;
+    printjson( res );
+    return res;
+}
+
+var before = loads( s );
+
+for ( var i = 10; i < 100; i += 10 )
+    assert.commandWorked( s.adminCommand( { split : "test.foo" , middle : { num : i } } ) , "B1 " + i );
+
+var after = loads( s );
+assert.lt( before.incremental.count , after.incremental.count , "B2" );
+assert.eq( "test.foo" , after.last.ns , "B3" );
+assert.eq( 10 , s.config.chunks.count( { ns : "test.foo" } ) , "B4" );
+
+// the other mongos catches up with a migration it didn't do
+var other = s.getOther( s.getServer( "test" ) ).name;
+assert.commandWorked( s.adminCommand( { moveChunk : "test.foo" , find : { num : 55 } , to : other } ) , "C1" );
+
+var before2 = loads( s2 );
+assert.eq( 100 , s2.getDB( "test" ).foo.find().itcount() , "C2" );
+assert.eq( 10 , s2.getDB( "test" ).foo.find( { num : { $gte : 50 , $lt : 60 } } ).itcount() , "C3" );
+assert.eq( 1 , s2.getDB( "test" ).foo.find( { num : 55 } ).itcount() , "C4" );
+var after2 = loads( s2 );
+assert.lt( before2.incremental.count , after2.incremental.count , "C5" );
+
+// dropping and sharding again from one mongos can't be patched over the other's old chunks
+db.foo.drop();
+s.adminCommand( { shardcollection : "test.foo" , key : { num : 1 } } );
+for ( var i = 0; i < 20; i++ )
+    db.foo.insert( { num : i } );
+db.getLastError();
+assert.eq( 20 , s2.getDB( "test" ).foo.find().itcount() , "D1" );
+assert.eq( 20 , s2.getDB( "test" ).foo.count() , "D2" );
+
+s.stop();
@@ -0,0 +1,82 @@
+// hashed_shard_key.js
+// { x : "hashed" } shard keys spread increasing values over all shards and route equality to one
+
+s = new ShardingTest( "hashed_shard_key" , 2 , 1 , 1 );
+s.stopBalancer();
+
+s.adminCommand( { enablesharding : "test" } );
+db = s.getDB( "test" );
+
+// bad keys and options
+assert.commandFailed( s.getDB( "admin" ).runCommand( { shardcollection : "test.bad" , key : { x : "hashed" , y : 1 } } ) , "A1" );
+assert.commandFailed( s.getDB( "admin" ).runCommand( { shardcollection : "test.bad" , key : { x : "hashed" } , unique : true } ) , "A2" );
+assert.commandFailed( s.getDB( "admin" ).runCommand( { shardcollection : "test.bad" , key : { x : 1 } , numInitialChunks : 4 } ) , "A3" );
+
+// an empty collection starts out spread over both shards
+assert.commandWorked( s.getDB( "admin" ).runCommand( { shardcollection : "test.foo" , key : { x : "hashed" } , numInitialChunks : 6 } ) , "B1" );
+assert.eq( 6 , s.config.chunks.count( { ns : "test.foo" } ) , "B2" );
+s.config.shards.find().forEach( function( z ) {
+    assert.eq( 3 , s.config.chunks.count( { ns : "test.foo" , shard : z._id } ) , "B3 " + z._id );
+} );
+s.config.chunks.find( { ns : "test.foo" } ).forEach( function( c ) {
+    assert( c.min.x == MinKey || c.min.x instanceof NumberLong , "B4 " + tojson( c ) );
+} );
+
+// increasing values land on both shards
+for ( var i = 0; i < 600; i++ )
+    db.foo.insert( { x : i , y : i % 10 } );
+assert.isnull( db.getLastError() , "C1" );
+assert.eq( 600 , db.foo.count() , "C2" );
+assert.eq( 600 , db.foo.find().itcount() , "C3" );
+s.config.shards.find().forEach( function( z ) {
+    var n = new Mongo( z.host ).getDB( "test" ).foo.count();
+    assert.lt( 100 , n , "C4 " + z._id );
+} );
+
+// documents need the key, and it can't be an array
+db.foo.insert( { y : 1 } );
+assert( db.getLastError() , "D1" );
+db.foo.insert( { x : [ 1 , 2 ] } );
+assert( db.getLastError() , "D2" );
+
+// equality goes to a single shard, anything else to all of them
+function numShards( q ) {
+    var e = db.foo.find( q ).explain();
+    return Object.keySet( e.shards ).length;
+}
+assert.eq( 1 , numShards( { x : 17 } ) , "E1" );
+assert.eq( 1 , numShards( { x : 17.0 } ) , "E2" );
+assert.eq( 1 , db.foo.find( { x : 17 } ).itcount() , "E3" );
+assert.eq( 5 , db.foo.find( { x : { $in : [ 1 , 2 , 3 , 4 , 5 ] } } ).itcount() , "E4" );
+assert.eq( 2 , numShards( { x : { $gt : 590 } } ) , "E5" );
+assert.eq( 9 , db.foo.find( { x : { $gt : 590 } } ).itcount() , "E6" );
+assert.eq( 2 , numShards( { y : 3 } ) , "E7" );
+
+// updates and removes by key
+db.foo.update( { x : 17 } , { $set : { y : 100 } } );
+assert.isnull( db.getLastError() , "F1" );
+assert.eq( 100 , db.foo.findOne( { x : 17 } ).y , "F2" );
+db.foo.remove( { x : 18 } );
+assert.eq( 599 , db.foo.count() , "F3" );
+
+// splits and migrations work on the hash
+assert.commandWorked( s.adminCommand( { split : "test.foo" , find : { x : 5 } } ) , "G1" );
+assert.eq( 7 , s.config.chunks.count( { ns : "test.foo" } ) , "G2" );
+
+var from = Object.keySet( db.foo.find( { x : 100 } ).explain().shards )[0];
+var other = s.config.shards.findOne( { host : { $ne : from } } )._id;
+assert.commandWorked( s.adminCommand( { moveChunk : "test.foo" , find : { x : 100 } , to : other } ) , "G3" );
+assert.eq( 599 , db.foo.find().itcount() , "G4" );
+assert.eq( 1 , db.foo.find( { x : 100 } ).itcount() , "G5" );
+
+// sharding an existing collection needs the hashed index
+for ( var i = 0; i < 100; i++ )
+    db.bar.insert( { x : i } );
+db.getLastError();
+assert.commandFailed( s.getDB( "admin" ).runCommand( { shardcollection : "test.bar" , key : { x : "hashed" } } ) , "H1" );
+db.bar.ensureIndex( { x : "hashed" } );
+assert.commandWorked( s.getDB( "admin" ).runCommand( { shardcollection : "test.bar" , key : { x : "hashed" } } ) , "H2" );
+assert.eq( 100 , db.bar.find().itcount() , "H3" );
+assert.eq( 1 , db.bar.find( { x : 42 } ).itcount() , "H4" );
+
+s.stop();
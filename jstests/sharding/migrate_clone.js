@@ -0,0 +1,62 @@
+// migrate_clone.js
+// the recipient of a migration clones documents in bulk, and both sides log the time and size of each step
+
+s = new ShardingTest( "migrate_clone" , 2 , 1 , 1 );
+s.stopBalancer();
+
+s.adminCommand( { enablesharding : "test" } );
+s.adminCommand( { shardcollection : "test.foo" , key : { num : 1 } } );
+
+db = s.getDB( "test" );
+
+N = 2000;
+var big = "";
+while ( big.length < 500 )
+    big += "x";
+for ( var i = 0; i < N; i++ )
+    db.foo.insert( { num : i , s : big } );
+db.getLastError();
+
+var primary = s.getServer( "test" );
+var other = s.getOther( primary );
+
+assert.commandWorked( s.adminCommand( { split : "test.foo" , middle : { num : N / 2 } } ) , "A1" );
+assert.commandWorked( s.adminCommand( { movechunk : "test.foo" , find : { num : N - 1 } , to : other.name } ) , "A2" );
+
+assert.eq( N / 2 , primary.getDB( "test" ).foo.count() , "B1" );
+assert.eq( N / 2 , other.getDB( "test" ).foo.count() , "B2" );
+assert.eq( N , db.foo.find().itcount() , "B3" );
+assert.eq( 1 , db.foo.find( { num : N - 1 } ).itcount() , "B4" );
+// the clone put the documents through the indexes too
+assert.eq( N / 2 , other.getDB( "test" ).foo.find().hint( { num : 1 } ).itcount() , "B5" );
+
+var to = s.config.changelog.find( { what : "moveChunk.to" , ns : "test.foo" } ).sort( { time : -1 } ).next();
+printjson( to );
+assert.eq( N / 2 , to.details.clonedDocs , "C1" );
+assert.lt( N / 2 * 500 , to.details.clonedBytes , "C2" );
+for ( var step = 1; step <= 5; step++ )
+    assert( to.details[ "step" + step ] >= 0 , "C3 " + step );
+assert.eq( 0 , to.details.catchupOps , "C4" );
+
+// moving it back works the same way
+assert.commandWorked( s.adminCommand( { movechunk : "test.foo" , find : { num : N - 1 } , to : primary.name } ) , "D1" );
+assert.eq( N , primary.getDB( "test" ).foo.count() , "D2" );
+assert.eq( N , db.foo.find().itcount() , "D3" );
+
+// the balancer can run migrations of different collections at once
+s.adminCommand( { shardcollection : "test.bar" , key : { num : 1 } } );
+for ( var i = 0; i < 10; i++ ) {
+    s.adminCommand( { split : "test.foo" , middle : { num : i * 100 + 50 } } );
+    s.adminCommand( { split : "test.bar" , middle : { num : i } } );
+}
+s.config.settings.update( { _id : "balancer" } , { $set : { stopped : false , parallelMigrations : true } } , true );
+assert.soon( function() {
+    var n = s.config.chunks.count( { ns : "test.bar" , shard : other.name } );
+    var m = s.config.chunks.count( { ns : "test.foo" , shard : other.name } );
+    print( "chunks on " + other.name + " bar: " + n + " foo: " + m );
+    return n >= 4 && m >= 4;
+} , "E1" , 5 * 60 * 1000 , 1000 );
+s.stopBalancer();
+assert.eq( N , db.foo.find().itcount() , "E2" );
+
+s.stop();
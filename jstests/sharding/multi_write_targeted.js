@@ -0,0 +1,71 @@
+// multi_write_targeted.js
+// multi updates and removes go only to the shards their shard key range reaches
+
+s = new ShardingTest( "multi_write_targeted" , 3 , 1 , 2 );
+s.stopBalancer();
+s2 = s._mongos[1];
+
+s.adminCommand( { enablesharding : "test" } );
+s.adminCommand( { shardcollection : "test.foo" , key : { a : 1 , b : 1 } } );
+
+db = s.getDB( "test" );
+
+for ( var i = 0; i < 300; i++ )
+    db.foo.insert( { a : i , b : i % 7 , x : 0 } );
+assert.isnull( db.getLastError() , "A1" );
+
+// [0,100) [100,200) [200,300) each on its own shard
+var primary = s.getServer( "test" );
+var shards = s.config.shards.find( { _id : { $ne : primary.name } } ).toArray();
+assert.commandWorked( s.adminCommand( { split : "test.foo" , middle : { a : 100 , b : 0 } } ) , "A2" );
+assert.commandWorked( s.adminCommand( { split : "test.foo" , middle : { a : 200 , b : 0 } } ) , "A3" );
+assert.commandWorked( s.adminCommand( { movechunk : "test.foo" , find : { a : 150 , b : 0 } , to : shards[0]._id } ) , "A4" );
+assert.commandWorked( s.adminCommand( { movechunk : "test.foo" , find : { a : 250 , b : 0 } , to : shards[1]._id } ) , "A5" );
+
+function update( d , q , v ) {
+    d.foo.update( q , { $set : { x : v } } , false , true );
+    var gle = d.getLastErrorObj();
+    printjson( gle );
+    assert.isnull( gle.err , "update " + tojson( q ) );
+    return gle;
+}
+
+// a range of the key's first field
+var gle = update( db , { a : { $gte : 10 , $lt : 50 } } , 1 );
+assert.eq( 1 , gle.numShards , "B1" );
+assert.eq( 40 , gle.n , "B2" );
+assert.eq( 40 , db.foo.count( { x : 1 } ) , "B3" );
+
+gle = update( db , { a : { $gte : 150 , $lt : 250 } , b : 3 } , 2 );
+assert.eq( 2 , gle.numShards , "B4" );
+assert.eq( db.foo.count( { a : { $gte : 150 , $lt : 250 } , b : 3 } ) , gle.n , "B5" );
+
+gle = update( db , { a : { $in : [ 5 , 295 ] } } , 3 );
+assert.eq( 2 , gle.numShards , "B6" );
+assert.eq( 2 , gle.n , "B7" );
+
+// without the first field it goes everywhere
+gle = update( db , { b : 6 } , 4 );
+assert.eq( 3 , gle.numShards , "B8" );
+assert.eq( db.foo.count( { b : 6 } ) , gle.n , "B9" );
+
+// removes
+db.foo.remove( { a : { $gte : 120 , $lt : 280 } , b : 0 } );
+gle = db.getLastErrorObj();
+printjson( gle );
+assert.eq( 2 , gle.numShards , "C1" );
+assert.eq( 0 , db.foo.count( { a : { $gte : 120 , $lt : 280 } , b : 0 } ) , "C2" );
+var left = db.foo.count();
+
+// the second mongos hasn't seen this chunk move, its update still reaches every document
+s2.getDB( "test" ).foo.findOne();
+assert.commandWorked( s.adminCommand( { movechunk : "test.foo" , find : { a : 50 , b : 0 } , to : shards[0]._id } ) , "D1" );
+update( s2.getDB( "test" ) , { a : { $gte : 0 , $lt : 200 } } , 5 );
+assert.eq( db.foo.count( { a : { $lt : 200 } } ) , db.foo.count( { x : 5 } ) , "D2" );
+
+s2.getDB( "test" ).foo.remove( { a : { $lt : 100 } } );
+assert.isnull( s2.getDB( "test" ).getLastError() , "D3" );
+assert.eq( 0 , db.foo.count( { a : { $lt : 100 } } ) , "D4" );
+assert.eq( left - 100 , db.foo.count() , "D5" );
+
+s.stop();
@@ -0,0 +1,70 @@
+// multi_write_writeback.js
+// a targeted multi $inc that a migration sends back to mongos is applied once per document
+
+s = new ShardingTest( "multi_write_writeback" , 3 , 1 , 2 );
+s.stopBalancer();
+s2 = s._mongos[1];
+
+s.adminCommand( { enablesharding : "test" } );
+s.adminCommand( { shardcollection : "test.foo" , key : { a : 1 } } );
+
+db = s.getDB( "test" );
+
+for ( var i = 0; i < 300; i++ )
+    db.foo.insert( { a : i , x : 0 } );
+assert.isnull( db.getLastError() , "A1" );
+
+// [0,100) on A, [100,200) on C, [200,300) on the third shard
+var shardA = s.getServer( "test" );
+var others = s.config.shards.find( { _id : { $ne : shardA.name } } ).toArray();
+var shardC = others[0]._id;
+assert.commandWorked( s.adminCommand( { split : "test.foo" , middle : { a : 100 } } ) , "A2" );
+assert.commandWorked( s.adminCommand( { split : "test.foo" , middle : { a : 200 } } ) , "A3" );
+assert.commandWorked( s.adminCommand( { movechunk : "test.foo" , find : { a : 150 } , to : shardC } ) , "A4" );
+assert.commandWorked( s.adminCommand( { movechunk : "test.foo" , find : { a : 250 } , to : others[1]._id } ) , "A5" );
+
+var q = { a : { $gte : 50 , $lt : 150 } };
+var expected = 0;
+
+function inc( msg ) {
+    db.foo.update( q , { $inc : { x : 1 } } , false , true );
+    var gle = db.getLastErrorObj();
+    printjson( gle );
+    assert.isnull( gle.err , msg );
+    expected++;
+}
+
+function check( msg ) {
+    db.foo.find().forEach( function( z ) {
+        var want = ( z.a >= 50 && z.a < 150 ) ? expected : 0;
+        assert.eq( want , z.x , msg + " a: " + z.a );
+    } );
+    assert.eq( 300 , db.foo.find().itcount() , msg + " count" );
+}
+
+inc( "B1" );
+check( "B2" );
+
+// the second mongos moves [0,100) between the two shards the $inc goes to, so this mongos routes
+// it with the old chunks and the donor writes it back
+var to = [ shardC , shardA.name ];
+for ( var round = 0; round < 4; round++ ) {
+    s2.getDB( "test" ).foo.findOne();
+    assert.commandWorked( s2.getDB( "admin" ).runCommand( { movechunk : "test.foo" , find : { a : 0 } , to : to[ round % 2 ] } ) , "C1 " + round );
+    inc( "C2 " + round );
+    check( "C3 " + round );
+}
+
+// and while the $incs are running
+var N = 50;
+join = startParallelShell( "for ( var i = 0; i < " + N + "; i++ ) { " +
+                           "  db.getSisterDB( 'test' ).foo.update( { a : { $gte : 50 , $lt : 150 } } , { $inc : { x : 1 } } , false , true ); " +
+                           "  assert.isnull( db.getSisterDB( 'test' ).getLastError() ); " +
+                           "}" );
+for ( var round = 0; round < 4; round++ )
+    s2.getDB( "admin" ).runCommand( { movechunk : "test.foo" , find : { a : 0 } , to : to[ round % 2 ] } );
+join();
+expected += N;
+check( "D1" );
+
+s.stop();
@@ -0,0 +1,63 @@
+// parallel_merge.js
+// mongos merges the shards' results in order across getMores, and pushes skip and limit down
+
+s = new ShardingTest( "parallel_merge" , 2 , 0 , 1 );
+s.stopBalancer();
+
+s.adminCommand( { enablesharding : "test" } );
+s.adminCommand( { shardcollection : "test.foo" , key : { num : 1 } } );
+
+db = s.getDB( "test" );
+
+N = 500;
+for ( var i = 0; i < N; i++ )
+    db.foo.insert( { num : i , x : ( i * 7 ) % N , s : "doc " + i } );
+db.getLastError();
+
+s.adminCommand( { split : "test.foo" , middle : { num : N / 2 } } );
+s.adminCommand( { movechunk : "test.foo" , find : { num : N - 1 } , to : s.getOther( s.getServer( "test" ) ).name } );
+assert.eq( 2 , s.config.chunks.count( { ns : "test.foo" } ) , "A1" );
+
+// x interleaves over both shards, so small batches need getMores from both while merging
+function checkSorted( c , dir , from , n , msg ) {
+    var a = c.toArray();
+    assert.eq( n , a.length , msg + " length" );
+    for ( var i = 0; i < a.length; i++ )
+        assert.eq( dir > 0 ? from + i : from - i , a[i].x , msg + " " + i );
+}
+checkSorted( db.foo.find().sort( { x : 1 } ) , 1 , 0 , N , "B1" );
+checkSorted( db.foo.find().sort( { x : -1 } ).batchSize( 7 ) , -1 , N - 1 , N , "B2" );
+checkSorted( db.foo.find().sort( { x : 1 } ).batchSize( 3 ).skip( 20 ) , 1 , 20 , N - 20 , "B3" );
+
+// skip with a soft limit and with a single batch hard limit
+checkSorted( db.foo.find().sort( { x : 1 } ).skip( 30 ).limit( 10 ) , 1 , 30 , 10 , "C1" );
+checkSorted( db.foo.find().sort( { x : 1 } ).skip( 30 ).limit( -10 ) , 1 , 30 , 10 , "C2" );
+checkSorted( db.foo.find().sort( { x : 1 } ).skip( 3 ).limit( -10 ) , 1 , 3 , 10 , "C3" );
+checkSorted( db.foo.find().sort( { x : -1 } ).skip( N - 5 ).limit( 10 ) , -1 , 4 , 5 , "C4" );
+
+// a query that goes to one shard does its skip there
+var q = { num : { $lt : N / 2 } , x : { $lt : 100 } };
+var all = db.foo.find( q ).sort( { x : 1 } ).toArray();
+var part = db.foo.find( q ).sort( { x : 1 } ).skip( 10 ).limit( -5 ).toArray();
+assert.eq( 5 , part.length , "D1" );
+for ( var i = 0; i < part.length; i++ )
+    assert.eq( all[10 + i].x , part[i].x , "D1 " + i );
+assert.eq( N / 2 - 10 , db.foo.find( { num : { $lt : N / 2 } } ).skip( 10 ).itcount() , "D2" );
+
+// without a sort every document still comes back exactly once
+var seen = {};
+var n = 0;
+db.foo.find().batchSize( 5 ).forEach( function( z ) { assert( ! seen[z.num] , "E1 " + z.num ); seen[z.num] = true; n++; } );
+assert.eq( N , n , "E2" );
+assert.eq( N - 40 , db.foo.find().batchSize( 5 ).skip( 40 ).itcount() , "E3" );
+
+// explain breaks the time down per shard
+var e = db.foo.find( { x : { $gt : 10 } } ).sort( { x : 1 } ).explain();
+printjson( e );
+assert.eq( 2 , e.numShards , "F1" );
+for ( var shard in e.shards ) {
+    assert.eq( 1 , e.shards[shard].length , "F2 " + shard );
+    assert( e.shards[shard][0].millisReceived >= 0 , "F3 " + shard );
+}
+
+s.stop();
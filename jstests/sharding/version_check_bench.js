@@ -0,0 +1,68 @@
+// version_check_bench.js
+// mongos throughput on a collection whose versions are already current everywhere,
+// and versions that do change are still noticed by a mongos that skips the checks
+
+s = new ShardingTest( "version_check_bench" , 2 , 1 , 2 );
+s.stopBalancer();
+s2 = s._mongos[1];
+
+s.adminCommand( { enablesharding : "test" } );
+s.adminCommand( { shardcollection : "test.foo" , key : { _id : 1 } } );
+
+db = s.getDB( "test" );
+
+N = 1000;
+for ( var i = 0; i < N; i++ )
+    db.foo.insert( { _id : i , x : 0 } );
+assert.isnull( db.getLastError() , "A1" );
+
+var primary = s.getServer( "test" );
+var other = s.getOther( primary );
+assert.commandWorked( s.adminCommand( { split : "test.foo" , middle : { _id : N / 2 } } ) , "A2" );
+assert.commandWorked( s.adminCommand( { movechunk : "test.foo" , find : { _id : N - 1 } , to : other.name } ) , "A3" );
+
+function bench( host , msg ) {
+    var res = benchRun( { ops : [ { ns : "test.foo" , op : "findOne" , query : { _id : { "#RAND_INT" : [ 0 , N ] } } } ,
+                                  { ns : "test.foo" , op : "update" , query : { _id : { "#RAND_INT" : [ 0 , N ] } } ,
+                                    update : { $inc : { x : 1 } } } ] ,
+                          parallel : 4 ,
+                          seconds : 5 ,
+                          totals : true ,
+                          host : host } );
+    print( msg + " findOne/s: " + res.findOne + " update/s: " + res.update );
+    printjson( res );
+    return res;
+}
+
+bench( primary.host , "direct to a shard" );
+var res = bench( s._mongos[0].host , "through mongos" );
+assert.lt( 0 , res.findOne , "B1" );
+assert.lt( 0 , res.update , "B2" );
+
+// every update counted once, however many times the versions were found current
+db.getLastError();
+var total = 0;
+db.foo.find().forEach( function( z ) { total += z.x; } );
+print( "updates applied: " + total );
+assert.lt( 0 , total , "B3" );
+
+// both mongos have checked their connections; move a chunk behind the second one's back
+s2.getDB( "test" ).foo.findOne( { _id : 0 } );
+s2.getDB( "test" ).foo.findOne( { _id : N - 1 } );
+assert.commandWorked( s.adminCommand( { movechunk : "test.foo" , find : { _id : 0 } , to : other.name } ) , "C1" );
+
+s2.getDB( "test" ).foo.update( { _id : 1 } , { $set : { y : 1 } } );
+assert.isnull( s2.getDB( "test" ).getLastError() , "C2" );
+assert.eq( 1 , other.getDB( "test" ).foo.count( { _id : 1 , y : 1 } ) , "C3" );
+assert.eq( 1 , s2.getDB( "test" ).foo.find( { _id : 2 } ).itcount() , "C4" );
+assert.eq( N , s2.getDB( "test" ).foo.find().itcount() , "C5" );
+
+// the shard stops accepting the second mongos' old version on connections that had already passed
+assert.commandWorked( s.adminCommand( { movechunk : "test.foo" , find : { _id : 0 } , to : primary.name } ) , "D1" );
+s2.getDB( "test" ).foo.insert( { _id : N + 1 } );
+s2.getDB( "test" ).foo.insert( { _id : -1 } );
+assert.isnull( s2.getDB( "test" ).getLastError() , "D2" );
+assert.eq( 1 , primary.getDB( "test" ).foo.count( { _id : -1 } ) , "D3" );
+assert.eq( N + 2 , db.foo.find().itcount() , "D4" );
+
+s.stop();
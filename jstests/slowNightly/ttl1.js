@@ -0,0 +1,38 @@
+// TTL collections: documents expire through a background job
+
+t = db.ttl1;
+t.drop();
+
+var now = (new Date()).getTime();
+
+for ( var i = 0; i < 24; i++ )
+    t.insert( { x : new Date( now - ( 3600 * 1000 * i ) ) } );
+t.insert( { x : new Date( now + 3600 * 1000 ) } );
+t.insert( { x : null } );
+t.insert( { x : "not a date" } );
+t.insert( { y : new Date( now - 3600 * 1000 * 24 ) } );
+db.getLastError();
+
+assert.eq( 28 , t.count() , "A1" );
+
+// bad options
+t.ensureIndex( { x : 1 } , { expireAfterSeconds : "a" } );
+assert( db.getLastError() , "B1" );
+t.ensureIndex( { x : 1 , y : 1 } , { expireAfterSeconds : 100 } );
+assert( db.getLastError() , "B2" );
+t.ensureIndex( { x : -1 } , { expireAfterSeconds : 100 } );
+assert( db.getLastError() , "B3" );
+assert.eq( 1 , t.getIndexes().length , "B4" );
+
+// documents older than 5.5 hours go away
+t.ensureIndex( { x : 1 } , { expireAfterSeconds : 20000 } );
+assert.isnull( db.getLastError() , "C1" );
+
+// the 6 newest past dates, the future date, and the 3 without a date
+assert.soon( function() { return t.count() == 10; } , "TTLMonitor never expired" , 130 * 1000 );
+assert.eq( 0 , t.find( { x : { $lt : new Date( now - 20000 * 1000 ) } } ).count() , "D1" );
+assert.eq( 3 , t.find( { x : { $not : { $type : 9 } } } ).count() , "D2" );
+
+var stats = db.serverStatus().ttl;
+assert( stats.totalRemoved >= 18 , "E1" );
+assert( stats.lastPass.indexes >= 1 , "E2" );
@@ -191,5 +191,40 @@ assert.eq( true , res.ok , "9a" );
 assert.eq( 1 , res.splitKeys.length , "9b" );
 assert.eq( 2 , res.splitKeys[0].x , "9c" );
 
+// -------------------------
+// Case 10: splitVector "sample" mode, where split points are estimated from the btree's buckets
+//
+
+res = db.runCommand( { splitVector: "test.jstests_splitvector" , keyPattern: {x:1} , force : true , sample : true } );
+
+assert.eq( true , res.ok , "10a" );
+assert.eq( 1 , res.splitKeys.length , "10b" );
+assert.eq( 2 , res.splitKeys[0].x , "10c" );
+
+f.drop();
+f.ensureIndex( { x: 1 } );
+for( i=0; i<numDocs; i++ ){
+    f.save( { x: i, y: filler } );
+}
+db.getLastError();
+
+walked = db.runCommand( { splitVector: "test.jstests_splitvector" , keyPattern: {x:1} , maxChunkSize: 1 } );
+res = db.runCommand( { splitVector: "test.jstests_splitvector" , keyPattern: {x:1} , maxChunkSize: 1 , sample : true } );
+
+assert.eq( true , res.ok , "10d" );
+assert.eq( true , res.sampled , "10e" );
+assert.close( walked.splitKeys.length , res.splitKeys.length , "10f" , -1 );
+for( i=1; i<res.splitKeys.length; i++ ){
+    assert.lt( res.splitKeys[i-1].x , res.splitKeys[i].x , "10g" );
+}
+
+// within a range, and with a limit on the number of split points
+res = db.runCommand( { splitVector: "test.jstests_splitvector" , keyPattern: {x:1} , min: {x:5000} , max: {x:15000} , maxChunkSize: 1 , maxSplitPoints: 2 , sample : true } );
+
+assert.eq( true , res.ok , "10h" );
+assert.eq( 2 , res.splitKeys.length , "10i" );
+assert.lt( 5000 , res.splitKeys[0].x , "10j" );
+assert.gt( 15000 , res.splitKeys[1].x , "10k" );
+
 
 print("PASSED");
@@ -39,63 +39,113 @@ namespace mongo {
     Balancer::~Balancer() {
     }
 
-    int Balancer::_moveChunks( const vector<CandidateChunkPtr>* candidateChunks ) {
-        int movedCount = 0;
+    int Balancer::_moveChunk( const CandidateChunk& chunkInfo ) {
+        DBConfigPtr cfg = grid.getDBConfig( chunkInfo.ns );
+        assert( cfg );
+
+        ChunkManagerPtr cm = cfg->getChunkManager( chunkInfo.ns );
+        assert( cm );
+
+        const BSONObj& chunkToMove = chunkInfo.chunk;
+        ChunkPtr c = cm->findChunkContaining( chunkToMove["min"].Obj() );
+        if ( c->getMin().woCompare( chunkToMove["min"].Obj() ) || c->getMax().woCompare( chunkToMove["max"].Obj() ) ) {
+            // likely a split happened somewhere
+            cm = cfg->getChunkManager( chunkInfo.ns , true /* reload */);
+            assert( cm );
 
-        for ( vector<CandidateChunkPtr>::const_iterator it = candidateChunks->begin(); it != candidateChunks->end(); ++it ) {
-            const CandidateChunk& chunkInfo = *it->get();
+            c = cm->findChunkContaining( chunkToMove["min"].Obj() );
+            if ( c->getMin().woCompare( chunkToMove["min"].Obj() ) || c->getMax().woCompare( chunkToMove["max"].Obj() ) ) {
+                log() << "chunk mismatch after reload, ignoring will retry issue cm: "
+                      << c->getMin() << " min: " << chunkToMove["min"].Obj() << endl;
+                return 0;
+            }
+        }
+
+        BSONObj res;
+        if ( c->moveAndCommit( Shard::make( chunkInfo.to ) , Chunk::MaxChunkSize , res ) ) {
+            return 1;
+        }
 
-            DBConfigPtr cfg = grid.getDBConfig( chunkInfo.ns );
-            assert( cfg );
+        // the move requires acquiring the collection metadata's lock, which can fail
+        log() << "balancer move failed: " << res << " from: " << chunkInfo.from << " to: " << chunkInfo.to
+              << " chunk: " << chunkToMove << endl;
 
-            ChunkManagerPtr cm = cfg->getChunkManager( chunkInfo.ns );
+        if ( res["chunkTooBig"].trueValue() ) {
+            // reload just to be safe
+            cm = cfg->getChunkManager( chunkInfo.ns );
             assert( cm );
+            c = cm->findChunkContaining( chunkToMove["min"].Obj() );
+            
+            log() << "forcing a split because migrate failed for size reasons" << endl;
+            
+            res = BSONObj();
+            c->singleSplit( true , res );
+            log() << "forced split results: " << res << endl;
+            
+            if ( ! res["ok"].trueValue() ) {
+                log() << "marking chunk as jumbo: " << c->toString() << endl;
+                c->markAsJumbo();
+                // we increment moveCount so we do another round right away
+                return 1;
+            }
 
-            const BSONObj& chunkToMove = chunkInfo.chunk;
-            ChunkPtr c = cm->findChunk( chunkToMove["min"].Obj() );
-            if ( c->getMin().woCompare( chunkToMove["min"].Obj() ) || c->getMax().woCompare( chunkToMove["max"].Obj() ) ) {
-                // likely a split happened somewhere
-                cm = cfg->getChunkManager( chunkInfo.ns , true /* reload */);
-                assert( cm );
-
-                c = cm->findChunk( chunkToMove["min"].Obj() );
-                if ( c->getMin().woCompare( chunkToMove["min"].Obj() ) || c->getMax().woCompare( chunkToMove["max"].Obj() ) ) {
-                    log() << "chunk mismatch after reload, ignoring will retry issue cm: "
-                          << c->getMin() << " min: " << chunkToMove["min"].Obj() << endl;
-                    continue;
-                }
+        }
+
+        return 0;
+    }
+
+    void Balancer::_moveChunkThread( const CandidateChunk* chunkInfo , int* moved ) {
+        setThreadName( "balancerMove" );
+        try {
+            *moved = _moveChunk( *chunkInfo );
+        }
+        catch ( std::exception& e ) {
+            log() << "balancer move of " << chunkInfo->chunk << " from: " << chunkInfo->from << " to: " << chunkInfo->to
+                  << " failed: " << e.what() << endl;
+        }
+    }
+
+    int Balancer::_moveChunks( const vector<CandidateChunkPtr>* candidateChunks , bool parallel ) {
+        int movedCount = 0;
+
+        if ( ! parallel || candidateChunks->size() < 2 ) {
+            for ( vector<CandidateChunkPtr>::const_iterator it = candidateChunks->begin(); it != candidateChunks->end(); ++it ) {
+                movedCount += _moveChunk( *it->get() );
             }
+            return movedCount;
+        }
 
-            BSONObj res;
-            if ( c->moveAndCommit( Shard::make( chunkInfo.to ) , Chunk::MaxChunkSize , res ) ) {
-                movedCount++;
-                continue;
+        // each wave takes the candidates whose shards aren't busy with an earlier one of the wave.
+        // candidates are for different collections, so their collection locks don't collide
+        vector<CandidateChunkPtr> left( *candidateChunks );
+        while ( ! left.empty() ) {
+            set<string> busy;
+            vector<CandidateChunkPtr> wave;
+            vector<CandidateChunkPtr> later;
+            for ( vector<CandidateChunkPtr>::iterator it = left.begin(); it != left.end(); ++it ) {
+                const CandidateChunk& chunkInfo = *it->get();
+                if ( busy.count( chunkInfo.from ) || busy.count( chunkInfo.to ) ) {
+                    later.push_back( *it );
+                    continue;
+                }
+                busy.insert( chunkInfo.from );
+                busy.insert( chunkInfo.to );
+                wave.push_back( *it );
             }
 
-            // the move requires acquiring the collection metadata's lock, which can fail
-            log() << "balancer move failed: " << res << " from: " << chunkInfo.from << " to: " << chunkInfo.to
-                  << " chunk: " << chunkToMove << endl;
+            LOG(1) << "balancer moving " << wave.size() << " chunks at once" << endl;
 
-            if ( res["chunkTooBig"].trueValue() ) {
-                // reload just to be safe
-                cm = cfg->getChunkManager( chunkInfo.ns );
-                assert( cm );
-                c = cm->findChunk( chunkToMove["min"].Obj() );
-                
-                log() << "forcing a split because migrate failed for size reasons" << endl;
-                
-                res = BSONObj();
-                c->singleSplit( true , res );
-                log() << "forced split results: " << res << endl;
-                
-                if ( ! res["ok"].trueValue() ) {
-                    log() << "marking chunk as jumbo: " << c->toString() << endl;
-                    c->markAsJumbo();
-                    // we increment moveCount so we do another round right away
-                    movedCount++;
-                }
+            vector<int> moved( wave.size() , 0 );
+            vector< shared_ptr<boost::thread> > threads;
+            for ( unsigned i=0; i<wave.size(); i++ )
+                threads.push_back( shared_ptr<boost::thread>( new boost::thread( boost::bind( &Balancer::_moveChunkThread , wave[i].get() , &moved[i] ) ) ) );
 
+            for ( unsigned i=0; i<threads.size(); i++ ) {
+                threads[i]->join();
+                movedCount += moved[i];
             }
+
+            left.swap( later );
         }
 
         return movedCount;
@@ -141,7 +191,42 @@ namespace mongo {
         return true;
     }
 
-    void Balancer::_doBalanceRound( DBClientBase& conn, vector<CandidateChunkPtr>* candidateChunks ) {
+    void Balancer::_getOpRates( const vector<Shard>& shards , map< string , map<string,double> >* rates ) {
+        for ( vector<Shard>::const_iterator it = shards.begin(); it != shards.end(); ++it ) {
+            const Shard& s = *it;
+
+            BSONObj totals;
+            try {
+                totals = s.runCommand( "admin" , "top" )["totals"].Obj();
+            }
+            catch ( std::exception& e ) {
+                log() << "couldn't get op counts from " << s.getName() << ": " << e.what() << endl;
+                continue;
+            }
+
+            unsigned long long now = curTimeMillis64();
+            map<string,long long>& last = _lastOps[ s.getName() ];
+            const bool hasLast = _lastOpsMillis.count( s.getName() ) > 0;
+            const double secs = hasLast ? ( now - _lastOpsMillis[ s.getName() ] ) / 1000.0 : 0;
+            _lastOpsMillis[ s.getName() ] = now;
+
+            BSONObjIterator i( totals );
+            while ( i.more() ) {
+                BSONElement e = i.next();
+                if ( e.type() != Object )
+                    continue;
+
+                long long count = e.Obj()["total"]["count"].numberLong();
+                map<string,long long>::iterator prev = last.find( e.fieldName() );
+                // counters start over when a shard restarts
+                if ( secs > 0 && prev != last.end() && count >= prev->second )
+                    (*rates)[ s.getName() ][ e.fieldName() ] = ( count - prev->second ) / secs;
+                last[ e.fieldName() ] = count;
+            }
+        }
+    }
+
+    void Balancer::_doBalanceRound( DBClientBase& conn, vector<CandidateChunkPtr>* candidateChunks , bool byCost ) {
         assert( candidateChunks );
 
         //
@@ -194,6 +279,10 @@ namespace mongo {
             shardLimitsMap[ s.getName() ] = limitsObj;
         }
 
+        map< string , map<string,double> > opRates;
+        if ( byCost )
+            _getOpRates( allShards , &opRates );
+
         //
         // 3. For each collection, check if the balancing policy recommends moving anything around.
         //
@@ -223,7 +312,28 @@ namespace mongo {
                 shardToChunksMap[s.getName()].size();
             }
 
-            CandidateChunk* p = _policy->balance( ns , shardLimitsMap , shardToChunksMap , _balancedLastTime );
+            CandidateChunk* p = 0;
+            if ( byCost ) {
+                // the collection's size and op rate on each shard; chunks are taken to share them evenly
+                BalancerPolicy::ShardToStatsMap shardToStatsMap;
+                for ( vector<Shard>::iterator i=allShards.begin(); i!=allShards.end(); ++i ) {
+                    const Shard& s = *i;
+                    long long size = 0;
+                    if ( ! shardToChunksMap[s.getName()].empty() ) {
+                        BSONObj res;
+                        ScopedDbConnection shardConn( s );
+                        if ( shardConn->runCommand( nsToDatabase( ns ) , BSON( "collStats" << ns.substr( ns.find( '.' ) + 1 ) ) , res ) )
+                            size = res["size"].numberLong();
+                        shardConn.done();
+                    }
+                    shardToStatsMap[s.getName()] = BSON( StatsFields::dataSize( size ) <<
+                                                         StatsFields::opsPerSec( opRates[s.getName()][ns] ) );
+                }
+                p = _policy->balanceByCost( ns , shardLimitsMap , shardToChunksMap , shardToStatsMap , _balancedLastTime );
+            }
+            else {
+                p = _policy->balance( ns , shardLimitsMap , shardToChunksMap , _balancedLastTime );
+            }
             if ( p ) candidateChunks->push_back( CandidateChunkPtr( p ) );
         }
     }
@@ -316,13 +426,18 @@ namespace mongo {
                     
                     LOG(1) << "*** start balancing round" << endl;
 
+                    // { _id : "balancer" , costAware : true } balances data size and op load instead
+                    // of chunk counts, and parallelMigrations : true lets migrations that share no
+                    // shard run at the same time
+                    BSONObj settings = grid.getConfigSetting( "balancer" );
+
                     vector<CandidateChunkPtr> candidateChunks;
-                    _doBalanceRound( conn.conn() , &candidateChunks );
+                    _doBalanceRound( conn.conn() , &candidateChunks , settings["costAware"].trueValue() );
                     if ( candidateChunks.size() == 0 ) {
                         LOG(1) << "no need to move any chunk" << endl;
                     }
                     else {
-                        _balancedLastTime = _moveChunks( &candidateChunks );
+                        _balancedLastTime = _moveChunks( &candidateChunks , settings["parallelMigrations"].trueValue() );
                     }
                     
                     LOG(1) << "*** end of balancing round" << endl;
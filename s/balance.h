@@ -34,6 +34,8 @@ namespace mongo {
      * checking the difference in chunks between the most and least loaded shards. It would issue a request for a chunk
      * migration per round, if it found so.
      */
+    class Shard;
+
     class Balancer : public BackgroundJob {
     public:
         Balancer();
@@ -60,6 +62,10 @@ namespace mongo {
 
         // decide which chunks to move; owned here.
         scoped_ptr<BalancerPolicy> _policy;
+
+        // last 'top' op counts per shard and ns, and when they were taken, for _getOpRates()
+        map< string , map<string,long long> > _lastOps;
+        map< string , unsigned long long > _lastOpsMillis;
         
         /**
          * Checks that the balancer can connect to all servers it needs to do its job.
@@ -76,16 +82,38 @@ namespace mongo {
          *
          * @param conn is the connection with the config server(s)
          * @param candidateChunks (IN/OUT) filled with candidate chunks, one per collection, that could possibly be moved
+         * @param byCost whether to weigh shards by data size and op load rather than by chunk count
+         */
+        void _doBalanceRound( DBClientBase& conn, vector<CandidateChunkPtr>* candidateChunks , bool byCost = false );
+
+        /**
+         * Samples the op counters of each shard's 'top' and turns them into per-namespace rates
+         * since the last sample.  A shard sampled for the first time has no rates yet.
+         *
+         * @param rates (OUT) shard name -> ns -> ops per second
          */
-        void _doBalanceRound( DBClientBase& conn, vector<CandidateChunkPtr>* candidateChunks );
+        void _getOpRates( const vector<Shard>& shards , map< string , map<string,double> >* rates );
 
         /**
-         * Issues chunk migration request, one at a time.
+         * Issues chunk migration requests, one at a time unless parallel is set.  In parallel,
+         * migrations that share no shard run at the same time, since a shard takes part in
+         * only one migration at a time.
          *
          * @param candidateChunks possible chunks to move
+         * @param parallel whether to run migrations between disjoint shard pairs concurrently
          * @return number of chunks effectively moved
          */
-        int _moveChunks( const vector<CandidateChunkPtr>* candidateChunks );
+        int _moveChunks( const vector<CandidateChunkPtr>* candidateChunks , bool parallel = false );
+
+        /**
+         * Issues one chunk migration request, splitting the chunk if it turns out too big to move.
+         *
+         * @return 1 if the chunk moved or had to be marked jumbo, 0 otherwise
+         */
+        static int _moveChunk( const CandidateChunk& chunkInfo );
+
+        /** _moveChunk() for a thread of its own, which can't let exceptions out */
+        static void _moveChunkThread( const CandidateChunk* chunkInfo , int* moved );
 
         /**
          * Marks this balancer as being live on the config server(s).
@@ -32,6 +32,10 @@ namespace mongo {
     BSONField<long long> LimitsFields::currSize( "currSize" );
     BSONField<bool> LimitsFields::hasOpsQueued( "hasOpsQueued" );
 
+    // stats map fields
+    BSONField<long long> StatsFields::dataSize( "dataSize" );
+    BSONField<double> StatsFields::opsPerSec( "opsPerSec" );
+
     BalancerPolicy::ChunkInfo* BalancerPolicy::balance( const string& ns,
             const ShardToLimitsMap& shardToLimitsMap,
             const ShardToChunksMap& shardToChunksMap,
@@ -136,6 +140,270 @@ namespace mongo {
         return new ChunkInfo( ns, to, from, chunkToMove );
     }
 
+    /**
+     * The collection's stats on 'shard', or, if there are none, what its chunks know of themselves.
+     */
+    static BSONObj statsFor( const string& shard , const vector<BSONObj>& chunks ,
+                             const BalancerPolicy::ShardToStatsMap& shardToStatsMap ) {
+        BalancerPolicy::ShardToStatsMap::const_iterator it = shardToStatsMap.find( shard );
+        if ( it != shardToStatsMap.end() )
+            return it->second;
+
+        long long data = 0;
+        double ops = 0;
+        for ( vector<BSONObj>::const_iterator i = chunks.begin(); i != chunks.end(); ++i ) {
+            data += (*i)[ StatsFields::dataSize.name() ].numberLong();
+            ops += (*i)[ StatsFields::opsPerSec.name() ].number();
+        }
+        return BSON( StatsFields::dataSize( data ) << StatsFields::opsPerSec( ops ) );
+    }
+
+    /**
+     * Turns data size, ops and chunk counts into a load relative to the average shard.  Data and
+     * ops count equally; chunks only count when there's neither.
+     */
+    class LoadModel {
+    public:
+        LoadModel( const BalancerPolicy::ShardToChunksMap& shardToChunksMap ,
+                   const BalancerPolicy::ShardToStatsMap& shardToStatsMap )
+            : _avgData(0) , _avgOps(0) , _avgChunks(0) {
+
+            for ( BalancerPolicy::ShardToChunksMap::const_iterator i = shardToChunksMap.begin(); i != shardToChunksMap.end(); ++i ) {
+                BSONObj stats = statsFor( i->first , i->second , shardToStatsMap );
+                _stats[i->first] = stats;
+                _avgData += stats[ StatsFields::dataSize.name() ].number();
+                _avgOps += stats[ StatsFields::opsPerSec.name() ].number();
+                _avgChunks += i->second.size();
+            }
+
+            if ( shardToChunksMap.empty() )
+                return;
+
+            _avgData /= shardToChunksMap.size();
+            _avgOps /= shardToChunksMap.size();
+            _avgChunks /= shardToChunksMap.size();
+        }
+
+        double load( double data , double ops , double chunks ) const {
+            double sum = 0;
+            int parts = 0;
+            if ( _avgData > 0 ) {
+                sum += data / _avgData;
+                parts++;
+            }
+            if ( _avgOps > 0 ) {
+                sum += ops / _avgOps;
+                parts++;
+            }
+            if ( parts == 0 )
+                return _avgChunks > 0 ? chunks / _avgChunks : 0;
+            return sum / parts;
+        }
+
+        double shardLoad( const string& shard , size_t numChunks ) const {
+            const BSONObj& s = stats( shard );
+            return load( s[ StatsFields::dataSize.name() ].number() , s[ StatsFields::opsPerSec.name() ].number() , numChunks );
+        }
+
+        double chunkLoad( const string& shard , const BSONObj& chunk , size_t numChunks ) const {
+            pair<double,double> cost = BalancerPolicy::chunkCost( chunk , stats( shard ) , numChunks );
+            return load( cost.first , cost.second , 1 );
+        }
+
+        const BSONObj& stats( const string& shard ) const {
+            map<string,BSONObj>::const_iterator it = _stats.find( shard );
+            assert( it != _stats.end() );
+            return it->second;
+        }
+
+    private:
+        map<string,BSONObj> _stats;
+        double _avgData;
+        double _avgOps;
+        double _avgChunks;
+    };
+
+    map<string,double> BalancerPolicy::shardLoads( const ShardToChunksMap& shardToChunksMap,
+            const ShardToStatsMap& shardToStatsMap ) {
+        LoadModel model( shardToChunksMap , shardToStatsMap );
+        map<string,double> loads;
+        for ( ShardToChunksIter i = shardToChunksMap.begin(); i != shardToChunksMap.end(); ++i )
+            loads[i->first] = model.shardLoad( i->first , i->second.size() );
+        return loads;
+    }
+
+    pair<double,double> BalancerPolicy::chunkCost( const BSONObj& chunk, const BSONObj& shardStats, size_t numChunks ) {
+        BSONElement data = chunk[ StatsFields::dataSize.name() ];
+        BSONElement ops = chunk[ StatsFields::opsPerSec.name() ];
+        double share = numChunks ? 1.0 / numChunks : 0;
+        return make_pair( data.isNumber() ? data.number() : shardStats[ StatsFields::dataSize.name() ].number() * share ,
+                          ops.isNumber() ? ops.number() : shardStats[ StatsFields::opsPerSec.name() ].number() * share );
+    }
+
+    /**
+     * Moving a chunk of load c changes the gap g between two shards into g - 2c, so the best chunk
+     * is the one that leaves |g - 2c| smallest.  A chunk worth g or more only turns the imbalance
+     * around, so none may be found, unless 'anyWillDo' because the donor has to be emptied anyway.
+     *
+     * @return the chunk to move from 'from' to 'to', or an empty object
+     */
+    static BSONObj pickChunkByCost( const LoadModel& model , const BalancerPolicy::ShardToChunksMap& shardToChunksMap ,
+                                    const string& from , const string& to , bool anyWillDo ) {
+        const vector<BSONObj>& chunksFrom = shardToChunksMap.find( from )->second;
+        const vector<BSONObj>& chunksTo = shardToChunksMap.find( to )->second;
+
+        const double gap = model.shardLoad( from , chunksFrom.size() ) - model.shardLoad( to , chunksTo.size() );
+        int best = -1;
+        double bestGap = anyWillDo ? numeric_limits<double>::max() : fabs( gap );
+        bool uniform = true;
+        double firstCost = 0;
+        for ( unsigned i = 0; i < chunksFrom.size(); i++ ) {
+            const double cost = model.chunkLoad( from , chunksFrom[i] , chunksFrom.size() );
+            if ( i == 0 )
+                firstCost = cost;
+            else if ( cost != firstCost )
+                uniform = false;
+
+            // loads are ratios, so ties have to be told apart from rounding
+            const double left = fabs( gap - 2 * cost );
+            if ( left < bestGap - 1e-9 ) {
+                best = i;
+                bestGap = left;
+            }
+        }
+
+        if ( best < 0 ) {
+            LOG(1) << "no chunk on " << from << " narrows its load gap of " << gap << " with " << to << endl;
+            return BSONObj();
+        }
+
+        // when every chunk weighs the same, prefer one that keeps ranges contiguous
+        BSONObj chunkToMove = uniform ? BalancerPolicy::pickChunk( chunksFrom , chunksTo ) : chunksFrom[best];
+        log() << "chose [" << from << "] to [" << to << "] " << chunkToMove << " load gap: " << gap << endl;
+        return chunkToMove;
+    }
+
+    BalancerPolicy::ChunkInfo* BalancerPolicy::balanceByCost( const string& ns,
+            const ShardToLimitsMap& shardToLimitsMap,
+            const ShardToChunksMap& shardToChunksMap,
+            const ShardToStatsMap& shardToStatsMap,
+            int balancedLastTime ) {
+        LoadModel model( shardToChunksMap , shardToStatsMap );
+
+        pair<string,double> min( "" , numeric_limits<double>::max() );
+        pair<string,double> max( "" , -1 );
+        vector<string> drainingShards;
+
+        bool maxOpsQueued = false;
+
+        for ( ShardToChunksIter i = shardToChunksMap.begin(); i != shardToChunksMap.end(); ++i ) {
+            const string& shard = i->first;
+            BSONObj shardLimits;
+            ShardToLimitsIter it = shardToLimitsMap.find( shard );
+            if ( it != shardToLimitsMap.end() ) shardLimits = it->second;
+            const bool maxedOut = isSizeMaxed( shardLimits );
+            const bool draining = isDraining( shardLimits );
+            const bool opsQueued = hasOpsQueued( shardLimits );
+
+            // same receiver candidates as balance()
+            const double load = model.shardLoad( shard , i->second.size() );
+            if ( ! maxedOut && ! draining && ! opsQueued ) {
+                if ( load < min.second ) {
+                    min = make_pair( shard , load );
+                }
+            }
+            else if ( opsQueued ) {
+                LOG(1) << "won't send a chunk to: " << shard << " because it has ops queued" << endl;
+            }
+            else if ( maxedOut ) {
+                LOG(1) << "won't send a chunk to: " << shard << " because it is maxedOut" << endl;
+            }
+
+            // a shard without chunks has nothing to give, however busy it is
+            if ( ! i->second.empty() && load > max.second ) {
+                max = make_pair( shard , load );
+                maxOpsQueued = opsQueued;
+            }
+            if ( draining && ! i->second.empty() ) {
+                drainingShards.push_back( shard );
+            }
+        }
+
+        if ( min.first.empty() ) {
+            log() << "no available shards to take chunks" << endl;
+            return NULL;
+        }
+
+        if ( maxOpsQueued ) {
+            log() << "busiest shard " << max.first << " has unprocessed writebacks, waiting for completion of migrate" << endl;
+            return NULL;
+        }
+
+        LOG(1) << "collection : " << ns << endl;
+        LOG(1) << "donor      : load " << max.second << " on " << max.first << endl;
+        LOG(1) << "receiver   : load " << min.second << " on " << min.first << endl;
+
+        // loads are relative to the average shard, so the threshold is a fraction of it.  As in
+        // balance(), a collection that's being balanced is brought closer than one that isn't.
+        const double threshold = balancedLastTime ? 0.1 : 0.2;
+        if ( ! max.first.empty() && max.first != min.first && max.second - min.second >= threshold ) {
+            BSONObj chunkToMove = pickChunkByCost( model , shardToChunksMap , max.first , min.first , false );
+            if ( ! chunkToMove.isEmpty() )
+                return new ChunkInfo( ns, min.first, max.first, chunkToMove );
+        }
+
+        // as in balance(), draining comes after imbalances, one draining shard per round
+        if ( ! drainingShards.empty() ) {
+            const string& from = drainingShards[ rand() % drainingShards.size() ];
+            return new ChunkInfo( ns, min.first, from, pickChunkByCost( model , shardToChunksMap , from , min.first , true ) );
+        }
+
+        // Everything is balanced here!
+        return NULL;
+    }
+
+    int BalancerPolicy::simulate( const string& ns, const ShardToLimitsMap& shardToLimitsMap,
+                                  ShardToChunksMap& shardToChunksMap, ShardToStatsMap& shardToStatsMap,
+                                  int maxRounds ) {
+        int moved = 0;
+        while ( moved < maxRounds ) {
+            scoped_ptr<ChunkInfo> c( balanceByCost( ns , shardToLimitsMap , shardToChunksMap , shardToStatsMap , moved ) );
+            if ( ! c )
+                break;
+
+            vector<BSONObj>& from = shardToChunksMap[c->from];
+            vector<BSONObj>& to = shardToChunksMap[c->to];
+            const BSONObj min = c->chunk["min"].Obj();
+
+            // the stats go along with the chunk, when there are shard stats to keep up to date
+            if ( shardToStatsMap.count( c->from ) || shardToStatsMap.count( c->to ) ) {
+                BSONObj fromStats = statsFor( c->from , from , shardToStatsMap );
+                BSONObj toStats = statsFor( c->to , to , shardToStatsMap );
+                pair<double,double> cost = chunkCost( c->chunk , fromStats , from.size() );
+                shardToStatsMap[c->from] = BSON( StatsFields::dataSize( fromStats[ StatsFields::dataSize.name() ].numberLong() - (long long)cost.first ) <<
+                                                 StatsFields::opsPerSec( fromStats[ StatsFields::opsPerSec.name() ].number() - cost.second ) );
+                shardToStatsMap[c->to] = BSON( StatsFields::dataSize( toStats[ StatsFields::dataSize.name() ].numberLong() + (long long)cost.first ) <<
+                                               StatsFields::opsPerSec( toStats[ StatsFields::opsPerSec.name() ].number() + cost.second ) );
+            }
+
+            for ( vector<BSONObj>::iterator i = from.begin(); i != from.end(); ++i ) {
+                if ( (*i)["min"].Obj().woCompare( min , BSONObj() , false ) == 0 ) {
+                    from.erase( i );
+                    break;
+                }
+            }
+
+            // chunks stay sorted by min, as the balancer reads them
+            vector<BSONObj>::iterator pos = to.begin();
+            while ( pos != to.end() && (*pos)["min"].Obj().woCompare( min , BSONObj() , false ) < 0 )
+                ++pos;
+            to.insert( pos , c->chunk );
+
+            moved++;
+        }
+        return moved;
+    }
+
     BSONObj BalancerPolicy::pickChunk( const vector<BSONObj>& from, const vector<BSONObj>& to ) {
         // It is possible for a donor ('from') shard to have less chunks than a receiver one ('to')
         // if the donor is in draining mode.
@@ -45,10 +45,49 @@ namespace mongo {
         static ChunkInfo* balance( const string& ns, const ShardToLimitsMap& shardToLimitsMap,
                                    const ShardToChunksMap& shardToChunksMap, int balancedLastTime );
 
+        /**
+         * Like balance(), but weighs each shard by the share of the collection's data it holds and
+         * of the collection's operations it serves, instead of by its number of chunks, and picks
+         * the chunk whose move narrows the gap between the busiest and the idlest shard the most.
+         *
+         * @param shardToStatsMap is a map from shardId to the collection's stats on that shard,
+         * { "dataSize" : <bytes> , "opsPerSec" : <n> } (see StatsFields). A chunk may carry the same
+         * fields for itself; otherwise it is taken to hold an even share of its shard's.
+         * Without any stats the load is the number of chunks.
+         */
+        typedef map< string,BSONObj > ShardToStatsMap;
+        static ChunkInfo* balanceByCost( const string& ns, const ShardToLimitsMap& shardToLimitsMap,
+                                         const ShardToChunksMap& shardToChunksMap,
+                                         const ShardToStatsMap& shardToStatsMap, int balancedLastTime );
+
+        /**
+         * Simulation mode: runs balanceByCost() round after round over a synthetic cluster, applying
+         * every suggested move to 'shardToChunksMap' and 'shardToStatsMap', until the policy has
+         * nothing left to move or 'maxRounds' moves were made.
+         *
+         * @return the number of chunks moved
+         */
+        static int simulate( const string& ns, const ShardToLimitsMap& shardToLimitsMap,
+                             ShardToChunksMap& shardToChunksMap, ShardToStatsMap& shardToStatsMap,
+                             int maxRounds );
+
+        /**
+         * @return each shard's load relative to the average shard: the mean of its share of data
+         * and its share of ops, whichever are known, or of chunks when neither is.  1 is average.
+         */
+        static map<string,double> shardLoads( const ShardToChunksMap& shardToChunksMap,
+                                              const ShardToStatsMap& shardToStatsMap );
+
         // below exposed for testing purposes only -- treat it as private --
 
         static BSONObj pickChunk( const vector<BSONObj>& from, const vector<BSONObj>& to );
 
+        /**
+         * @return the data size and ops of 'chunk' on a shard with 'numChunks' chunks and 'shardStats',
+         * using the chunk's own StatsFields when it has them
+         */
+        static pair<double,double> chunkCost( const BSONObj& chunk, const BSONObj& shardStats, size_t numChunks );
+
         /**
          * Returns true if a shard cannot receive any new chunks bacause it reache 'shardLimits'.
          * Expects the optional fields "maxSize", can in size in MB, and "usedSize", currently used size
@@ -93,6 +132,14 @@ namespace mongo {
         static BSONField<bool> hasOpsQueued;  // writeback queue is not empty?
     };
 
+    /**
+     * Field names used in the 'stats' map, and optionally on chunks, for balanceByCost().
+     */
+    struct StatsFields {
+        static BSONField<long long> dataSize; // bytes of the collection
+        static BSONField<double> opsPerSec;   // operations on the collection per second
+    };
+
 }  // namespace mongo
 
 #endif  // S_BALANCER_POLICY_HEADER
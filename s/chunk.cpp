@@ -78,6 +78,11 @@ namespace mongo {
         : _manager(info), _min(min), _max(max), _shard(shard), _lastmod(0), _jumbo(false), _dataWritten(mkDataWritten())
     {}
 
+    Chunk::Chunk(const ChunkManager * info , const Chunk& other)
+        : _manager(info), _min(other._min), _max(other._max), _shard(other._shard), _lastmod(other._lastmod),
+          _jumbo(other._jumbo), _dataWritten(other._dataWritten)
+    {}
+
     long Chunk::mkDataWritten() {
         return rand() % ( MaxChunkSize / 5 );
     }
@@ -227,8 +232,9 @@ namespace mongo {
 
         // We assume that if the chunk being split is the first (or last) one on the collection, this chunk is
         // likely to see more insertions. Instead of splitting mid-chunk, we use the very first (or last) key
-        // as a split point.
-        if ( minIsInf() ) {
+        // as a split point.  Hashed keys spread inserts over all chunks, so there is no hot end there.
+        const bool hotEnds = ! _manager->getShardKey().isHashed();
+        if ( hotEnds && minIsInf() ) {
             splitPoint.clear();
             BSONObj key = _getExtremeKey( 1 );
             if ( ! key.isEmpty() ) {
@@ -236,7 +242,7 @@ namespace mongo {
             }
 
         }
-        else if ( maxIsInf() ) {
+        else if ( hotEnds && maxIsInf() ) {
             splitPoint.clear();
             BSONObj key = _getExtremeKey( -1 );
             if ( ! key.isEmpty() ) {
@@ -332,9 +338,31 @@ namespace mongo {
         return worked;
     }
 
+    // shard servers that split their own chunks
+    static mongo::mutex shardsSplittingMutex( "shardsSplitting" );
+    static set<string> shardsSplitting;
+
+    void Chunk::setShardSplitsChunks( const string& host ) {
+        scoped_lock lk( shardsSplittingMutex );
+        shardsSplitting.insert( host );
+    }
+
+    bool Chunk::shardSplitsChunks() const {
+        scoped_lock lk( shardsSplittingMutex );
+        for ( set<string>::const_iterator i = shardsSplitting.begin(); i != shardsSplitting.end(); ++i ) {
+            if ( getShard().containsNode( *i ) )
+                return true;
+        }
+        return false;
+    }
+
     bool Chunk::splitIfShould( long dataWritten ) const {
         LastError::Disabled d( lastError.get() );
 
+        // the shard counts what every mongos writes to the chunk and splits it when it fills up
+        if ( shardSplitsChunks() )
+            return false;
+
         try {
             _dataWritten += dataWritten;
             int splitThreshold = getManager()->getCurrentDesiredChunkSize();
@@ -398,7 +426,7 @@ namespace mongo {
                 }
 
                 ChunkManagerPtr cm = _manager->reload(false/*just reloaded in mulitsplit*/);
-                ChunkPtr toMove = cm->findChunk(min);
+                ChunkPtr toMove = cm->findChunkContaining(min);
 
                 if ( ! (toMove->getMin() == min && toMove->getMax() == max) ){
                     LOG(1) << "recently split chunk: " << range << " modified before we could migrate " << toMove << endl;
@@ -539,9 +567,39 @@ namespace mongo {
 
     // -------  ChunkManager --------
 
+    ChunkManagerLoadStats chunkManagerLoadStats;
+
+    ChunkManagerLoadStats::ChunkManagerLoadStats() : _m( "ChunkManagerLoadStats" ) {
+    }
+
+    void ChunkManagerLoadStats::loaded( const string& ns , bool incremental , int chunks , int millis ) {
+        scoped_lock lk( _m );
+        Totals& t = incremental ? _incremental : _full;
+        t.count++;
+        t.chunks += chunks;
+        t.millis += millis;
+        _last = BSON( "ns" << ns << "incremental" << incremental << "chunks" << chunks << "millis" << millis << "when" << jsTime() );
+    }
+
+    void ChunkManagerLoadStats::append( BSONObjBuilder& b ) const {
+        scoped_lock lk( _m );
+        const Totals* all[] = { &_full , &_incremental };
+        const char* names[] = { "full" , "incremental" };
+        for ( int i = 0; i < 2; i++ ) {
+            BSONObjBuilder t( b.subobjStart( names[i] ) );
+            t.appendNumber( "count" , all[i]->count );
+            t.appendNumber( "chunks" , all[i]->chunks );
+            t.appendNumber( "millis" , all[i]->millis );
+            t.done();
+        }
+        b.appendNumber( "fallbacks" , (long long)_fallbacks.get() );
+        if ( ! _last.isEmpty() )
+            b.append( "last" , _last );
+    }
+
     AtomicUInt ChunkManager::NextSequenceNumber = 1;
 
-    ChunkManager::ChunkManager( string ns , ShardKeyPattern pattern , bool unique ) :
+    ChunkManager::ChunkManager( string ns , ShardKeyPattern pattern , bool unique , ChunkManagerPtr old ) :
         _ns( ns ) , _key( pattern ) , _unique( unique ) , _chunkRanges(), _mutex("ChunkManager"),
         _nsLock( ConnectionString( configServer.modelServer() , ConnectionString::SYNC ) , ns ),
 
@@ -553,22 +611,46 @@ namespace mongo {
         _splitTickets( 5 )
 
     {
+        // the old chunks are only worth reusing if they describe the same sharding of ns
+        if ( old && ! ( old->getVersion().isSet() && old->_key.key() == _key.key() && old->_unique == _unique ) )
+            old.reset();
+
         int tries = 3;
         while (tries--) {
             ChunkMap chunkMap;
             set<Shard> shards;
             ShardVersionMap shardVersions;
             Timer t;
-            _load(chunkMap, shards, shardVersions);
-            {
-                int ms = t.millis();
-                log() << "ChunkManager: time to load chunks for " << ns << ": " << ms << "ms" 
-                      << " sequenceNumber: " << _sequenceNumber 
-                      << " version: " << _version.toString() 
-                      << endl;
+
+            // only the first attempt is incremental, retries start from scratch
+            bool incremental = false;
+            int changed = 0;
+            if ( old && tries == 2 ) {
+                incremental = _loadChanged( *old, chunkMap, shards, shardVersions, changed ) && _isValid( chunkMap );
+                if ( ! incremental ) {
+                    log() << "ChunkManager: couldn't apply the chunks changed since " << old->getVersion().toString()
+                          << " for " << ns << ", loading all chunks" << endl;
+                    chunkMap.clear();
+                    shards.clear();
+                    shardVersions.clear();
+                    _version = 0;
+                    chunkManagerLoadStats.fellBack();
+                }
             }
 
-            if (_isValid(chunkMap)) {
+            if ( ! incremental )
+                _load(chunkMap, shards, shardVersions);
+
+            int ms = t.millis();
+            log() << "ChunkManager: time to load " << ( incremental ? "changed chunks" : "chunks" ) << " for " << ns << ": " << ms << "ms" 
+                  << " sequenceNumber: " << _sequenceNumber 
+                  << " version: " << _version.toString() 
+                  << ( incremental ? " changed: " : " chunks: " ) << ( incremental ? changed : (int)chunkMap.size() )
+                  << endl;
+
+            if (incremental || _isValid(chunkMap)) {
+                chunkManagerLoadStats.loaded( ns , incremental , incremental ? changed : (int)chunkMap.size() , ms );
+
                 // These variables are const for thread-safety. Since the
                 // constructor can only be called from one thread, we don't have
                 // to worry about that here.
@@ -627,6 +709,76 @@ namespace mongo {
         conn.done();
     }
 
+    /**
+     * fills chunks with a copy of old's chunks patched with the ones whose version is newer than old's.
+     * a split or migrate bumps the version of every chunk it touches, so those cover all that changed.
+     * @param changed set to the number of chunks read
+     * @return false if the result can't be trusted and everything has to be read instead
+     */
+    bool ChunkManager::_loadChanged(const ChunkManager& old, ChunkMap& chunkMap, set<Shard>& shards, ShardVersionMap& shardVersions, int& changed) {
+        ScopedDbConnection conn( configServer.modelServer() );
+
+        BSONObjBuilder q;
+        q.append( "ns" , _ns );
+        {
+            BSONObjBuilder lastmod( q.subobjStart( "lastmod" ) );
+            lastmod.appendTimestamp( "$gt" , old.getVersion() );
+            lastmod.done();
+        }
+
+        vector<ChunkPtr> newer;
+        auto_ptr<DBClientCursor> cursor = conn->query( Chunk::chunkMetadataNS, Query( q.obj() ) );
+        assert( cursor.get() );
+        while ( cursor->more() ) {
+            BSONObj d = cursor->next();
+            if ( d["isMaxMarker"].trueValue() ) {
+                continue;
+            }
+            newer.push_back( ChunkPtr( new Chunk( this, d ) ) );
+        }
+
+        // counted after the query, so a split committed in between shows up as a mismatch
+        unsigned long long total = conn->count( Chunk::chunkMetadataNS, BSON( "ns" << _ns << "isMaxMarker" << BSON( "$ne" << true ) ) );
+        conn.done();
+
+        changed = newer.size();
+
+        // nothing newer means the collection was dropped and sharded again with lower versions
+        if ( newer.empty() )
+            return false;
+
+        // chunks point back at their manager, so they can't be shared with old
+        for ( ChunkMap::const_iterator i = old._chunkMap.begin(); i != old._chunkMap.end(); ++i )
+            chunkMap[i->first] = ChunkPtr( new Chunk( this, *i->second ) );
+
+        BSONObjCmp cmp;
+        for ( vector<ChunkPtr>::const_iterator i = newer.begin(); i != newer.end(); ++i ) {
+            const ChunkPtr& c = *i;
+
+            // replace whatever the chunk covers now: its old self, or the chunk it was split from
+            ChunkMap::iterator j = chunkMap.upper_bound( c->getMin() );
+            while ( j != chunkMap.end() && cmp( j->second->getMin() , c->getMax() ) )
+                chunkMap.erase( j++ );
+
+            chunkMap[c->getMax()] = c;
+        }
+
+        _version = 0;
+        for ( ChunkMap::const_iterator i = chunkMap.begin(); i != chunkMap.end(); ++i ) {
+            const ChunkPtr& c = i->second;
+            shards.insert( c->getShard() );
+
+            if ( c->getLastmod() > _version )
+                _version = c->getLastmod();
+
+            ShardChunkVersion& shardMax = shardVersions[c->getShard()];
+            if ( c->getLastmod() > shardMax )
+                shardMax = c->getLastmod();
+        }
+
+        return chunkMap.size() == total;
+    }
+
     bool ChunkManager::_isValid(const ChunkMap& chunkMap) {
 #define ENSURE(x) do { if(!(x)) { log() << "ChunkManager::_isValid failed: " #x << endl; return false; } } while(0)
 
@@ -664,14 +816,14 @@ namespace mongo {
         return _key.hasShardKey( obj );
     }
 
-    void ChunkManager::createFirstChunks( const Shard& shard ) const {
+    void ChunkManager::createFirstChunks( const Shard& primary , int numInitialChunks ) const {
         // TODO distlock?
         assert( _chunkMap.size() == 0 );
 
         unsigned long long numObjects = 0;
         {
             // get stats to see if there is any data
-            ScopedDbConnection shardConn( shard.getConnString() );
+            ScopedDbConnection shardConn( primary.getConnString() );
             numObjects = shardConn->count( getns() );
             shardConn.done();
         }
@@ -680,22 +832,42 @@ namespace mongo {
         ShardChunkVersion version;
         version.incMajor();
 
-        Chunk c(this, _key.globalMin(), _key.globalMax(), shard);
+        Chunk c(this, _key.globalMin(), _key.globalMax(), primary);
 
         vector<BSONObj> splitPoints;
-        if ( numObjects > 0 )
+        vector<Shard> shards;
+        if ( numObjects > 0 ) {
             c.pickSplitVector( splitPoints , Chunk::MaxChunkSize );
+        }
+        else if ( _key.isHashed() ) {
+            // nothing to move yet, so the chunks can be spread right away: cut the signed 64 bit
+            // hash range into equal parts and deal them out to the shards in turn
+            Shard::getAllShards( shards );
+            if ( shards.empty() )
+                shards.push_back( primary );
+            unsigned long long n = numInitialChunks > 0 ? numInitialChunks : 2 * shards.size();
+            unsigned long long step = numeric_limits<unsigned long long>::max() / n;
+            const char * field = _key.key().firstElementFieldName();
+            for ( unsigned long long i = 1; i < n; i++ ) {
+                // offset from the lowest hash, computed unsigned so it can't overflow
+                long long h = (long long)( ( 1ULL << 63 ) + i * step );
+                splitPoints.push_back( BSON( field << h ) );
+            }
+        }
         
         log() << "going to create " << splitPoints.size() + 1 << " chunk(s) for: " << _ns << endl;
         
 
         ScopedDbConnection conn( configServer.modelServer() );        
 
+        set<Shard> used;
         for ( unsigned i=0; i<=splitPoints.size(); i++ ) {
             BSONObj min = i == 0 ? _key.globalMin() : splitPoints[i-1];
             BSONObj max = i < splitPoints.size() ? splitPoints[i] : _key.globalMax();
+            Shard owner = shards.empty() ? primary : shards[ i % shards.size() ];
+            used.insert( owner );
             
-            Chunk temp( this , min , max , shard );
+            Chunk temp( this , min , max , owner );
         
             BSONObjBuilder chunkBuilder;
             temp.serialize( chunkBuilder , version );
@@ -717,17 +889,21 @@ namespace mongo {
 
         if ( numObjects == 0 ) {
             // the ensure index will have the (desired) indirect effect of creating the collection on the
-            // assigned shard, as it sets up the index over the sharding keys.
-            ScopedDbConnection shardConn( c.getShard().getConnString() );
-            shardConn->ensureIndex( getns() , getShardKey().key() , _unique , "" , false ); // do not cache ensureIndex SERVER-1691 
-            shardConn.done();
+            // assigned shards, as it sets up the index over the sharding keys.
+            for ( set<Shard>::const_iterator i = used.begin(); i != used.end(); ++i ) {
+                ScopedDbConnection shardConn( i->getConnString() );
+                shardConn->ensureIndex( getns() , getShardKey().key() , _unique , "" , false ); // do not cache ensureIndex SERVER-1691 
+                shardConn.done();
+            }
         }
 
     }
 
     ChunkPtr ChunkManager::findChunk( const BSONObj & obj ) const {
-        BSONObj key = _key.extractKey(obj);
+        return findChunkContaining( _key.chunkKey( _key.extractKey( obj ) ) );
+    }
 
+    ChunkPtr ChunkManager::findChunkContaining( const BSONObj& key ) const {
         {
             BSONObj foo;
             ChunkPtr c;
@@ -787,6 +963,27 @@ namespace mongo {
 
         do {
             boost::scoped_ptr<FieldRangeSetPair> frsp (org.topFrsp());
+
+            if ( _key.isHashed() ) {
+                // hashing keeps nothing but equality: each point the query allows is routed by its
+                // hash, any other range may have documents in every chunk
+                const char * field = _key.key().firstElementFieldName();
+                BoundList points = frsp->singleKeyIndexBounds( BSON( field << 1 ), 1 );
+                for (BoundList::const_iterator it=points.begin(), end=points.end(); it != end; ++it) {
+                    if ( it->first.woCompare( it->second ) != 0 ) {
+                        getAllShards( shards );
+                        return;
+                    }
+                    shards.insert( findChunkContaining( _key.chunkKey( it->first.replaceFieldNames( _key.key() ) ) )->getShard() );
+                }
+
+                if( shards.size() == _shards.size() ) return;
+
+                if (org.moreOrClauses())
+                    org.popOrClauseSingleKey();
+                continue;
+            }
+
             {
                 // special case if most-significant field isn't in query
                 FieldRange range = frsp->singleKeyRange(_key.key().firstElementFieldName());
@@ -57,6 +57,9 @@ namespace mongo {
         Chunk( const ChunkManager * info , BSONObj from);
         Chunk( const ChunkManager * info , const BSONObj& min, const BSONObj& max, const Shard& shard);
 
+        /** a copy of other that belongs to info, keeping its version, jumbo flag and write count */
+        Chunk( const ChunkManager * info , const Chunk& other );
+
         //
         // serialization support
         //
@@ -99,6 +102,9 @@ namespace mongo {
          */
         bool splitIfShould( long dataWritten ) const;
 
+        /** @return true if this chunk's shard splits its chunks itself, see setShardSplitsChunks() */
+        bool shardSplitsChunks() const;
+
         /**
          * Splits this chunk at a non-specificed split key to be chosen by the mongod holding this chunk.
          *
@@ -166,6 +172,12 @@ namespace mongo {
          */
          static void refreshChunkSize();
 
+        /**
+         * Marks the shard server at 'host' as one that finds and splits its full chunks itself,
+         * so mongos needn't ask it for split points.
+         */
+        static void setShardSplitsChunks( const string& host );
+
         //
         // public constants
         //
@@ -299,15 +311,29 @@ namespace mongo {
     public:
         typedef map<Shard,ShardChunkVersion> ShardVersionMap;
 
-        ChunkManager( string ns , ShardKeyPattern pattern , bool unique );
+        /**
+         * @param old if set, only the chunks changed since old's version are read from the
+         *            config server and applied to a copy of old's chunks
+         */
+        ChunkManager( string ns , ShardKeyPattern pattern , bool unique , ChunkManagerPtr old = ChunkManagerPtr() );
 
         string getns() const { return _ns; }
 
         int numChunks() const { return _chunkMap.size(); }
         bool hasShardKey( const BSONObj& obj ) const;
 
-        void createFirstChunks( const Shard& shard ) const; // only call from DBConfig::shardCollection
+        /**
+         * only call from DBConfig::shardCollection
+         * @param numInitialChunks for an empty collection with a hashed shard key, how many chunks to
+         *        spread evenly over the hash range and the shards; 0 for two per shard
+         */
+        void createFirstChunks( const Shard& primary , int numInitialChunks = 0 ) const;
+
+        /** @return the chunk a document, or a query with the full shard key, belongs to */
         ChunkPtr findChunk( const BSONObj& obj ) const;
+
+        /** @return the chunk that contains key, a point in chunk space such as a chunk boundary */
+        ChunkPtr findChunkContaining( const BSONObj& key ) const;
         ChunkPtr findChunkOnServer( const Shard& shard ) const;
 
         const ShardKeyPattern& getShardKey() const {  return _key; }
@@ -315,7 +341,7 @@ namespace mongo {
 
         void getShardsForQuery( set<Shard>& shards , const BSONObj& query ) const;
         void getAllShards( set<Shard>& all ) const;
-        void getShardsForRange(set<Shard>& shards, const BSONObj& min, const BSONObj& max, bool fullKeyReq = true) const; // [min, max)
+        void getShardsForRange(set<Shard>& shards, const BSONObj& min, const BSONObj& max, bool fullKeyReq = true) const; // [min, max) in chunk space
 
         ChunkMap getChunkMap() const { return _chunkMap; }
 
@@ -335,6 +361,15 @@ namespace mongo {
          */
         unsigned long long getSequenceNumber() const { return _sequenceNumber; }
 
+        /**
+         * @return a number that moves on whenever a collection's ChunkManager is installed or dropped,
+         * so a version check that was current at some epoch holds for as long as the epoch does
+         */
+        static unsigned getRoutingEpoch() { return NextSequenceNumber.get(); }
+
+        /** to be called after installing or dropping a collection's ChunkManager */
+        static void routingChanged() { NextSequenceNumber++; }
+
         void getInfo( BSONObjBuilder& b ) const {
             b.append( "key" , _key.key() );
             b.appendBool( "unique" , _unique );
@@ -354,6 +389,7 @@ namespace mongo {
 
         // helpers for constructor
         void _load(ChunkMap& chunks, set<Shard>& shards, ShardVersionMap& shardVersions);
+        bool _loadChanged(const ChunkManager& old, ChunkMap& chunks, set<Shard>& shards, ShardVersionMap& shardVersions, int& changed);
         static bool _isValid(const ChunkMap& chunks);
 
         // All members should be const for thread-safety
@@ -382,6 +418,33 @@ namespace mongo {
         static AtomicUInt NextSequenceNumber;
     };
 
+    /**
+     * how ChunkManagers were loaded, reported by serverStatus.
+     * a full load reads every chunk of the collection, an incremental one only
+     * those whose version is newer than the previous ChunkManager's.
+     */
+    class ChunkManagerLoadStats {
+    public:
+        ChunkManagerLoadStats();
+        void loaded( const string& ns , bool incremental , int chunks , int millis );
+        void fellBack() { _fallbacks++; }
+        void append( BSONObjBuilder& b ) const;
+    private:
+        struct Totals {
+            Totals() : count(0), chunks(0), millis(0) { }
+            long long count;
+            long long chunks;
+            long long millis;
+        };
+        mutable mongo::mutex _m;
+        Totals _full;
+        Totals _incremental;
+        AtomicUInt _fallbacks; // incremental loads that had to read everything instead
+        BSONObj _last;
+    };
+
+    extern ChunkManagerLoadStats chunkManagerLoadStats;
+
     // like BSONObjCmp. for use as an STL comparison functor
     // key-order in "order" argument must match key-order in shardkey
     class ChunkCmp {
@@ -134,6 +134,44 @@ namespace mongo {
 
 
 
+    /**
+     * sends the getLastError command to each of the shards without waiting for any reply,
+     * so the shards wait for their writes (w, fsync...) at the same time.  the connections
+     * stay checked out until the caller has joined the command and called done() on them
+     */
+    static void spawnGetLastError( const vector<string>& shards , const BSONObj& options ,
+                                   vector< shared_ptr<ShardConnection> >& conns ,
+                                   vector< shared_ptr<Future::CommandResult> >& results ) {
+        for ( unsigned i=0; i<shards.size(); i++ ) {
+            shared_ptr<ShardConnection> conn( new ShardConnection( shards[i] , "" ) );
+            results.push_back( Future::spawnCommand( shards[i] , "admin" , options , 0 , conn->get() ) );
+            conns.push_back( conn );
+        }
+    }
+
+    void ClientInfo::_blockOnOtherShards( const set<string>& skip , vector<WBInfo>& writebacks ) {
+        vector<string> others;
+        for ( set<string>::const_iterator i=sinceLastGetError().begin(); i!=sinceLastGetError().end(); ++i ) {
+            if ( ! skip.count( *i ) )
+                others.push_back( *i );
+        }
+
+        vector< shared_ptr<ShardConnection> > conns;
+        vector< shared_ptr<Future::CommandResult> > results;
+        spawnGetLastError( others , BSON( "getlasterror" << 1 ) , conns , results );
+
+        for ( unsigned i=0; i<others.size(); i++ ) {
+            try {
+                results[i]->join();
+                _addWriteBack( writebacks , results[i]->result() );
+            }
+            catch( std::exception &e ){
+                warning() << "could not clear last error from a shard " << others[i] << causedBy( e ) << endl;
+            }
+            conns[i]->done();
+        }
+    }
+
     bool ClientInfo::getLastError( const BSONObj& options , BSONObjBuilder& result , bool fromWriteBackListener ) {
         set<string> * shards = getPrev();
 
@@ -173,22 +211,7 @@ namespace mongo {
             _addWriteBack( writebacks , res );
 
             // hit other machines just to block
-            for ( set<string>::const_iterator i=sinceLastGetError().begin(); i!=sinceLastGetError().end(); ++i ) {
-                string temp = *i;
-                if ( temp == theShard )
-                    continue;
-
-                ShardConnection conn( temp , "" );
-
-                try {
-                    _addWriteBack( writebacks , conn->getLastErrorDetailed() );
-                }
-                catch( std::exception &e ){
-                    warning() << "could not clear last error from shard " << temp << causedBy( e ) << endl;
-                }
-
-                conn.done();
-            }
+            _blockOnOtherShards( *shards , writebacks );
             clearSinceLastGetError();
             
             if ( writebacks.size() ){
@@ -212,6 +235,7 @@ namespace mongo {
             }
             else {
                 result.append( "singleShard" , theShard );
+                result.append( "numShards" , 1 );
                 result.appendElements( res );
             }
             
@@ -225,23 +249,31 @@ namespace mongo {
         
         int updatedExistingStat = 0; // 0 is none, -1 has but false, 1 has true
 
-        // hit each shard
+        // hit each shard, all at once
+        vector<string> gleShards( shards->begin() , shards->end() );
+        vector< shared_ptr<ShardConnection> > conns;
+        vector< shared_ptr<Future::CommandResult> > results;
+        spawnGetLastError( gleShards , options , conns , results );
+
         vector<string> errors;
         vector<BSONObj> errorObjects;
-        for ( set<string>::iterator i = shards->begin(); i != shards->end(); i++ ) {
-            string theShard = *i;
+        for ( unsigned i=0; i<gleShards.size(); i++ ) {
+            string theShard = gleShards[i];
+            ShardConnection& conn = *conns[i];
             bbb.append( theShard );
-            ShardConnection conn( theShard , "" );
             BSONObj res;
             bool ok = false;
             try {
-                ok = conn->runCommand( "admin" , options , res );
+                ok = results[i]->join();
+                res = results[i]->result();
+                uassert( 15954 , "no reply" , ok || ! res.isEmpty() );
                 shardRawGLE.append( theShard , res );
             }
             catch( std::exception &e ){
 
         	    // Safe to return here, since we haven't started any extra processing yet, just collecting
-        	    // responses.
+        	    // responses.  connections still waiting on a reply are dropped rather than
+        	    // returned to the pool.
                 
         	    warning() << "could not get last error from a shard " << theShard << causedBy( e ) << endl;
                 conn.done();
@@ -269,6 +301,7 @@ namespace mongo {
         }
 
         bbb.done();
+        result.append( "numShards" , (int)gleShards.size() );
         result.append( "shardRawGLE" , shardRawGLE.obj() );
 
         result.appendNumber( "n" , n );
@@ -276,20 +309,7 @@ namespace mongo {
             result.appendBool( "updatedExisting" , updatedExistingStat > 0 );
 
         // hit other machines just to block
-        for ( set<string>::const_iterator i=sinceLastGetError().begin(); i!=sinceLastGetError().end(); ++i ) {
-            string temp = *i;
-            if ( shards->count( temp ) )
-                continue;
-
-            ShardConnection conn( temp , "" );
-            try {
-                _addWriteBack( writebacks, conn->getLastErrorDetailed() );
-            }
-            catch( std::exception &e ){
-                warning() << "could not clear last error from a shard " << temp << causedBy( e ) << endl;
-            }
-            conn.done();
-        }
+        _blockOnOtherShards( *shards , writebacks );
         clearSinceLastGetError();
 
         if ( errors.size() == 0 ) {
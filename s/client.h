@@ -25,6 +25,9 @@
 
 namespace mongo {
 
+    class ChunkManager;
+    typedef shared_ptr<const ChunkManager> ChunkManagerPtr;
+
     /**
      * holds information about a client connected to a mongos
      * 1 per client socket
@@ -87,6 +90,18 @@ namespace mongo {
         
         void noAutoSplit() { _autoSplitOk = false; }
 
+        /**
+         * the host a write being replayed by the writeback listener came back from, empty otherwise,
+         * and the chunk manager the write was first routed with, if still known.  the other shards
+         * it was routed to applied it already
+         */
+        const string& getWritebackHost() const { return _writebackHost; }
+        ChunkManagerPtr getWritebackManager() const { return _writebackManager; }
+        void setWriteback( const string& host , ChunkManagerPtr sentWith ) {
+            _writebackHost = host;
+            _writebackManager = sentWith;
+        }
+
         static ClientInfo * get();
         const AuthenticationInfo* getAuthenticationInfo() const { return (AuthenticationInfo*)&_ai; }
         AuthenticationInfo* getAuthenticationInfo() { return (AuthenticationInfo*)&_ai; }
@@ -102,6 +117,8 @@ namespace mongo {
         // for getLastError
         void _addWriteBack( vector<WBInfo>& all , const BSONObj& o );
         vector<BSONObj> _handleWriteBacks( vector<WBInfo>& all , bool fromWriteBackListener );
+        /** waits for the writes on shards used since the last getLastError that aren't in skip */
+        void _blockOnOtherShards( const set<string>& skip , vector<WBInfo>& writebacks );
 
 
         int _id; // unique client id
@@ -121,6 +138,8 @@ namespace mongo {
 
         int _lastAccess;
         bool _autoSplitOk; 
+        string _writebackHost;
+        ChunkManagerPtr _writebackManager;
 
         static boost::thread_specific_ptr<ClientInfo> _tlInfo;
     };
@@ -163,6 +163,12 @@ namespace mongo {
 
                 result.append( "shardCursorType" , shardedCursorTypes.getObj() );
 
+                {
+                    BSONObjBuilder bb( result.subobjStart( "chunkManagerLoads" ) );
+                    chunkManagerLoadStats.append( bb );
+                    bb.done();
+                }
+
                 {
                     BSONObjBuilder asserts( result.subobjStart( "asserts" ) );
                     asserts.append( "regular" , assertionCount.regular );
@@ -378,10 +384,15 @@ namespace mongo {
         public:
             ShardCollectionCmd() : GridAdminCmd( "shardCollection" ) {}
 
+            /** upper bound for numInitialChunks */
+            static const int MaxInitialChunks = 8192;
+
             virtual void help( stringstream& help ) const {
                 help
                         << "Shard a collection.  Requires key.  Optional unique. Sharding must already be enabled for the database.\n"
-                        << "  { enablesharding : \"<dbname>\" }\n";
+                        << "  { enablesharding : \"<dbname>\" }\n"
+                        << "  { shardcollection : \"<ns>\" , key : { <field> : \"hashed\" } , numInitialChunks : <n> } spreads\n"
+                        << "  writes by the hash of a single field, an empty collection starts with n chunks over all shards\n";
             }
 
             bool run(const string& , BSONObj& cmdObj, int, string& errmsg, BSONObjBuilder& result, bool) {
@@ -408,9 +419,22 @@ namespace mongo {
                     return false;
                 }
 
-                BSONForEach(e, key) {
-                    if (!e.isNumber() || e.number() != 1.0) {
-                        errmsg = "shard keys must all be ascending";
+                const bool hashed = ShardKeyPattern::isHashedPattern( key );
+                if ( ! hashed ) {
+                    BSONForEach(e, key) {
+                        if (!e.isNumber() || e.number() != 1.0) {
+                            errmsg = "shard keys must all be ascending, or a single hashed field";
+                            return false;
+                        }
+                    }
+                }
+
+                int numInitialChunks = 0;
+                if ( cmdObj["numInitialChunks"].isNumber() ) {
+                    numInitialChunks = cmdObj["numInitialChunks"].numberInt();
+                    if ( ! hashed || numInitialChunks < 1 || numInitialChunks > MaxInitialChunks ) {
+                        errmsg = str::stream() << "numInitialChunks must be between 1 and " << MaxInitialChunks
+                                               << " and needs a hashed shard key";
                         return false;
                     }
                 }
@@ -440,6 +464,10 @@ namespace mongo {
                 // We enforce both these conditions in what comes next.
 
                 bool careAboutUnique = cmdObj["unique"].trueValue();
+                if ( hashed && careAboutUnique ) {
+                    errmsg = "hashed shard keys can't be unique";
+                    return false;
+                }
 
                 {
                     ShardKeyPattern proposedKey( key );
@@ -529,7 +557,7 @@ namespace mongo {
 
                 tlog() << "CMD: shardcollection: " << cmdObj << endl;
 
-                config->shardCollection( ns , key , careAboutUnique );
+                config->shardCollection( ns , key , careAboutUnique , numInitialChunks );
 
                 result << "collectionsharded" << ns;
                 return true;
@@ -614,8 +642,9 @@ namespace mongo {
                 }
 
                 ChunkManagerPtr info = config->getChunkManager( ns );
-                ChunkPtr chunk = info->findChunk( find );
                 BSONObj middle = cmdObj.getObjectField( "middle" );
+                // find is a document, middle a split point and so already in chunk space
+                ChunkPtr chunk = cmdObj.getObjectField( "find" ).isEmpty() ? info->findChunkContaining( middle ) : info->findChunk( find );
 
                 assert( chunk.get() );
                 log() << "splitting: " << ns << "  shard: " << chunk << endl;
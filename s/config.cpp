@@ -64,6 +64,7 @@ namespace mongo {
 
     void DBConfig::CollectionInfo::shard( const string& ns , const ShardKeyPattern& key , bool unique ) {
         _cm.reset( new ChunkManager( ns , key , unique ) );
+        ChunkManager::routingChanged();
         _key = key.key().getOwned();
         _unqiue = unique;
         _dirty = true;
@@ -72,6 +73,7 @@ namespace mongo {
 
     void DBConfig::CollectionInfo::unshard() {
         _cm.reset();
+        ChunkManager::routingChanged();
         _dropped = true;
         _dirty = true;
         _key = BSONObj();
@@ -130,7 +132,7 @@ namespace mongo {
         _save();
     }
 
-    ChunkManagerPtr DBConfig::shardCollection( const string& ns , ShardKeyPattern fieldsAndOrder , bool unique ) {
+    ChunkManagerPtr DBConfig::shardCollection( const string& ns , ShardKeyPattern fieldsAndOrder , bool unique , int numInitialChunks ) {
         uassert( 8042 , "db doesn't have sharding enabled" , _shardingEnabled );
         uassert( 13648 , str::stream() << "can't shard collection because not all config servers are up" , configServer.allUp() );
 
@@ -146,7 +148,7 @@ namespace mongo {
             ci.shard( ns , fieldsAndOrder , unique );
             ChunkManagerPtr cm = ci.getCM();
             uassert( 13449 , "collections already sharded" , (cm->numChunks() == 0) );
-            cm->createFirstChunks( getPrimary() );
+            cm->createFirstChunks( getPrimary() , numInitialChunks );
             _save();
         }
 
@@ -188,6 +190,7 @@ namespace mongo {
         BSONObj key;
         bool unique;
         ShardChunkVersion oldVersion;
+        ChunkManagerPtr old;
 
         {
             scoped_lock lk( _lock );
@@ -208,8 +211,10 @@ namespace mongo {
 
             key = ci.key().copy();
             unique = ci.unique();
-            if ( ci.getCM() )
-                oldVersion = ci.getCM()->getVersion();
+            if ( ci.getCM() ) {
+                old = ci.getCM();
+                oldVersion = old->getVersion();
+            }
         }
         
         assert( ! key.isEmpty() );
@@ -259,7 +264,8 @@ namespace mongo {
                 
             }
             
-            temp.reset( new ChunkManager( ns , key , unique ) );
+            // a forced reload doesn't trust what we have, read every chunk again
+            temp.reset( new ChunkManager( ns , key , unique , forceReload ? ChunkManagerPtr() : old ) );
             if ( temp->numChunks() == 0 ) {
                 // maybe we're not sharded any more
                 reload(); // this is a full reload
@@ -344,6 +350,9 @@ namespace mongo {
             else _collections[o["_id"].String()] = CollectionInfo( o );
         }
 
+        // collections may have been dropped above
+        ChunkManager::routingChanged();
+
         conn.done();
 
         return true;
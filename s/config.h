@@ -85,6 +85,7 @@ namespace mongo {
                 assert(cm);
                 assert(_cm); // this has to be already sharded
                 _cm.reset( cm );
+                ChunkManager::routingChanged();
             }
 
             void shard( const string& ns , const ShardKeyPattern& key , bool unique );
@@ -131,7 +132,8 @@ namespace mongo {
         }
 
         void enableSharding();
-        ChunkManagerPtr shardCollection( const string& ns , ShardKeyPattern fieldsAndOrder , bool unique );
+        /** @param numInitialChunks see ChunkManager::createFirstChunks */
+        ChunkManagerPtr shardCollection( const string& ns , ShardKeyPattern fieldsAndOrder , bool unique , int numInitialChunks = 0 );
 
         /**
            @return true if there was sharding info to remove
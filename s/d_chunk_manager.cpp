@@ -24,6 +24,7 @@
 #include "../db/clientcursor.h"
 
 #include "d_chunk_manager.h"
+#include "shardkey.h"
 
 namespace mongo {
 
@@ -77,6 +78,7 @@ namespace mongo {
         uassert( 13542 , str::stream() << "collection doesn't have a key: " << collectionDoc , ! e.eoo() && e.isABSONObj() );
 
         BSONObj keys = e.Obj().getOwned();
+        _hashed = ShardKeyPattern::isHashedPattern( keys );
         BSONObjBuilder b;
         BSONForEach( key , keys ) {
             b.append( key.fieldName() , 1 );
@@ -143,14 +145,16 @@ namespace mongo {
         if ( _rangesMap.size() == 0 )
             return false;
         
-        return _belongsToMe( cc->extractFields( _key , true ) );
+        BSONObj key = cc->extractFields( _key , true );
+        return _belongsToMe( _hashed ? ShardKeyPattern::hashedKey( key ) : key );
     }
 
     bool ShardChunkManager::belongsToMe( const BSONObj& obj ) const {
         if ( _rangesMap.size() == 0 )
             return false;
 
-        return _belongsToMe( obj.extractFields( _key , true ) );
+        BSONObj key = obj.extractFields( _key , true );
+        return _belongsToMe( _hashed ? ShardKeyPattern::hashedKey( key ) : key );
     }
 
     bool ShardChunkManager::_belongsToMe( const BSONObj& x ) const {
@@ -200,6 +204,27 @@ namespace mongo {
         return true;
     }
 
+    bool ShardChunkManager::getChunkContaining( const BSONObj& obj , BSONObj* foundMin , BSONObj* foundMax ) const {
+        assert( foundMin );
+        assert( foundMax );
+
+        BSONObj key = obj.extractFields( _key , true );
+        if ( _hashed )
+            key = ShardKeyPattern::hashedKey( key );
+
+        RangeMap::const_iterator it = _chunksMap.upper_bound( key );
+        if ( it == _chunksMap.begin() )
+            return false;
+        it--;
+
+        if ( ! contains( it->first , it->second , key ) )
+            return false;
+
+        *foundMin = it->first;
+        *foundMax = it->second;
+        return true;
+    }
+
     void ShardChunkManager::_assertChunkExists( const BSONObj& min , const BSONObj& max ) const {
         RangeMap::const_iterator it = _chunksMap.find( min );
         if ( it == _chunksMap.end() ) {
@@ -222,6 +247,7 @@ namespace mongo {
 
         auto_ptr<ShardChunkManager> p( new ShardChunkManager );
         p->_key = this->_key;
+        p->_hashed = this->_hashed;
 
         if ( _chunksMap.size() == 1 ) {
             // if left with no chunks, just reset version
@@ -275,6 +301,7 @@ namespace mongo {
         auto_ptr<ShardChunkManager> p( new ShardChunkManager );
 
         p->_key = this->_key;
+        p->_hashed = this->_hashed;
         p->_chunksMap = this->_chunksMap;
         p->_chunksMap.insert( make_pair( min.getOwned() , max.getOwned() ) );
         p->_version = version;
@@ -307,6 +334,7 @@ namespace mongo {
         auto_ptr<ShardChunkManager> p( new ShardChunkManager );
 
         p->_key = this->_key;
+        p->_hashed = this->_hashed;
         p->_chunksMap = this->_chunksMap;
         p->_version = version; // will increment second, third, ... chunks below
 
@@ -121,6 +121,16 @@ namespace mongo {
          */
         bool getNextChunk( const BSONObj& lookupKey, BSONObj* foundMin , BSONObj* foundMax ) const;
 
+        /**
+         * Finds the chunk of this shard that holds a document.
+         *
+         * @param obj document containing sharding keys (and, optionally, other attributes)
+         * @param foundMin IN/OUT min for the chunk holding 'obj'
+         * @param foundMax IN/OUT max for the above chunk
+         * @return false if no chunk of this shard holds 'obj'
+         */
+        bool getChunkContaining( const BSONObj& obj , BSONObj* foundMin , BSONObj* foundMax ) const;
+
         // accessors
 
         ShardChunkVersion getVersion() const { return _version; }
@@ -142,6 +152,9 @@ namespace mongo {
         // key pattern for chunks under this range
         BSONObj _key;
 
+        // chunks partition the hash of the single _key field, see ShardKeyPattern::isHashed
+        bool _hashed;
+
         // a map from a min key into the chunk's (or range's) max boundary
         typedef map< BSONObj, BSONObj , BSONObjCmp > RangeMap;
         RangeMap _chunksMap;
@@ -159,7 +172,7 @@ namespace mongo {
         void _assertChunkExists( const BSONObj& min , const BSONObj& max ) const;
 
         /** can only be used in the cloning calls */
-        ShardChunkManager() {}
+        ShardChunkManager() : _hashed( false ) {}
     };
 
     typedef shared_ptr<ShardChunkManager> ShardChunkManagerPtr;
@@ -43,6 +43,26 @@ using namespace std;
 
 namespace mongo {
 
+    /**
+     * Counts the documents of an insert, or an update by its query, towards their chunks' auto-split.
+     */
+    static void noteWritesForAutoSplit( int op , DbMessage& d , const char* ns ) {
+        if ( op == dbInsert ) {
+            while ( d.moreJSObjs() ) {
+                BSONObj o = d.nextJsObj();
+                noteWriteForAutoSplit( ns , o , o.objsize() );
+            }
+            return;
+        }
+
+        d.pullInt(); // flags
+        BSONObj query = d.nextJsObj();
+        if ( d.moreJSObjs() ) {
+            BSONObj toupdate = d.nextJsObj();
+            noteWriteForAutoSplit( ns , query , toupdate.objsize() );
+        }
+    }
+
     bool _handlePossibleShardedMessage( Message &m, DbResponse* dbresponse ) {
         DEV assert( shardingState.enabled() );
 
@@ -57,6 +77,8 @@ namespace mongo {
         const char *ns = d.getns();
         string errmsg;
         if ( shardVersionOk( ns , errmsg ) ) {
+            if ( op == dbInsert || op == dbUpdate )
+                noteWritesForAutoSplit( op , d , ns );
             return false;
         }
 
@@ -42,6 +42,7 @@ namespace mongo {
 
         bool enabled() const { return _enabled; }
         const string& getConfigServer() const { return _configServer; }
+        string getShardName();
         void enable( const string& server );
 
         void gotShardName( const string& name );
@@ -56,6 +57,12 @@ namespace mongo {
         bool hasVersion( const string& ns , ConfigVersion& version );
         const ConfigVersion getVersion( const string& ns ) const;
 
+        /**
+         * @return a number that changes whenever any collection's manager is installed, replaced or removed.
+         * Read without locking, so a connection can tell its last version check still holds.
+         */
+        unsigned getGeneration() const { return _generation.get(); }
+
         /**
          * Uninstalls the manager for a given collection. This should be used when the collection is dropped.
          *
@@ -151,6 +158,9 @@ namespace mongo {
         // a ShardChunkManager carries all state we need for a collection at this shard, including its version information
         typedef map<string,ShardChunkManagerPtr> ChunkManagersMap;
         ChunkManagersMap _chunks;
+
+        // bumped after every change to _chunks, while still holding _mutex
+        AtomicUInt _generation;
     };
 
     extern ShardingState shardingState;
@@ -170,6 +180,10 @@ namespace mongo {
         const ConfigVersion getVersion( const string& ns ) const;
         void setVersion( const string& ns , const ConfigVersion& version );
 
+        /** @return true if this connection's version for 'ns' was found ok at sharding state 'generation' */
+        bool versionOkAt( const string& ns , unsigned generation ) const;
+        void noteVersionOk( const string& ns , unsigned generation );
+
         static ShardedConnectionInfo* get( bool create );
         static void reset();
         static void addHook();
@@ -189,6 +203,10 @@ namespace mongo {
         typedef map<string,ConfigVersion> NSVersionMap;
         NSVersionMap _versions;
 
+        // sharding state generation at which the version for a namespace was last found ok
+        typedef map<string,unsigned> NSGenerationMap;
+        NSGenerationMap _okAt;
+
         static boost::thread_specific_ptr<ShardedConnectionInfo> _tl;
     };
 
@@ -238,6 +256,13 @@ namespace mongo {
     }
 
     void logOpForSharding( const char * opstr , const char * ns , const BSONObj& obj , BSONObj * patt );
+
+    /**
+     * Counts 'bytes' written to the chunk of 'ns' holding 'obj', a document or a query with the whole
+     * shard key, whichever mongos sent them.  Chunks that took in enough are checked and split from here.
+     */
+    void noteWriteForAutoSplit( const string& ns , const BSONObj& obj , int bytes );
+    void appendAutoSplitInfo( BSONObjBuilder& b );
     void aboutToDeleteForSharding( const Database* db , const DiskLoc& dl );
 
 }
@@ -35,6 +35,7 @@
 #include "../db/repl_block.h"
 #include "../db/dur.h"
 #include "../db/clientcursor.h"
+#include "../db/oplog.h"
 
 #include "../client/connpool.h"
 #include "../client/distlock.h"
@@ -105,6 +106,11 @@ namespace mongo {
         }
 
 
+        /** records a count next to the step times, e.g. how many documents a step moved */
+        void count( const string& field , long long n ) {
+            _b.appendNumber( field , n );
+        }
+
         void note( const string& s ) {
             string field = "note";
             if ( _nextNote > 0 ) {
@@ -131,12 +137,21 @@ namespace mongo {
 
     };
 
+    /**
+     * @return the index removeRange and the clone scan should use for chunks of shardKeyPattern:
+     *         the hashed index for hashed keys, else empty to pick the ascending one over the key
+     */
+    static BSONObj shardKeyIndex( const BSONObj& shardKeyPattern ) {
+        return ShardKeyPattern::isHashedPattern( shardKeyPattern ) ? shardKeyPattern : BSONObj();
+    }
+
     struct OldDataCleanup {
         static AtomicUInt _numThreads; // how many threads are doing async cleanup
 
         string ns;
         BSONObj min;
         BSONObj max;
+        BSONObj shardKeyPattern;
         set<CursorId> initial;
 
         OldDataCleanup(){
@@ -146,6 +161,7 @@ namespace mongo {
             ns = other.ns;
             min = other.min.getOwned();
             max = other.max.getOwned();
+            shardKeyPattern = other.shardKeyPattern.getOwned();
             initial = other.initial;
             _numThreads++;
         }
@@ -162,7 +178,7 @@ namespace mongo {
             {
                 writelock lk(ns);
                 RemoveSaver rs("moveChunk",ns,"post-cleanup");
-                long long numDeleted = Helpers::removeRange( ns , min , max , true , false , cmdLine.moveParanoia ? &rs : 0 );
+                long long numDeleted = Helpers::removeRange( ns , min , max , true , false , cmdLine.moveParanoia ? &rs : 0 , shardKeyIndex( shardKeyPattern ) );
                 log() << "moveChunk deleted: " << numDeleted << migrateLog;
             }
             
@@ -201,8 +217,13 @@ namespace mongo {
 
     };
 
-    bool isInRange( const BSONObj& obj , const BSONObj& min , const BSONObj& max ) {
+    /**
+     * @param shardKeyPattern if hashed, obj is placed by the hash of its shard key
+     */
+    bool isInRange( const BSONObj& obj , const BSONObj& min , const BSONObj& max , const BSONObj& shardKeyPattern ) {
         BSONObj k = obj.extractFields( min, true );
+        if ( ShardKeyPattern::isHashedPattern( shardKeyPattern ) )
+            k = ShardKeyPattern::hashedKey( k );
 
         return k.woCompare( min ) >= 0 && k.woCompare( max ) < 0;
     }
@@ -217,7 +238,7 @@ namespace mongo {
             _memoryUsed = 0;
         }
 
-        void start( string ns , const BSONObj& min , const BSONObj& max ) {
+        void start( string ns , const BSONObj& min , const BSONObj& max , const BSONObj& shardKeyPattern ) {
             scoped_lock ll(_workLock);
             scoped_lock l(_m); // reads and writes _active
 
@@ -230,6 +251,7 @@ namespace mongo {
             _ns = ns;
             _min = min;
             _max = max;
+            _shardKeyPattern = shardKeyPattern;
 
             assert( _cloneLocs.size() == 0 );
             assert( _deleted.size() == 0 );
@@ -312,7 +334,7 @@ namespace mongo {
 
             }
 
-            if ( ! isInRange( it , _min , _max ) )
+            if ( ! isInRange( it , _min , _max , _shardKeyPattern ) )
                 return;
 
             _reload.push_back( ide.wrap() );
@@ -389,7 +411,7 @@ namespace mongo {
                 return false;
             }
 
-            BSONObj keyPattern;
+            BSONObj keyPattern = shardKeyIndex( _shardKeyPattern );
             // the copies are needed because the indexDetailsForRange destroys the input
             BSONObj min = _min.copy();
             BSONObj max = _max.copy();
@@ -561,6 +583,7 @@ namespace mongo {
         string _ns;
         BSONObj _min;
         BSONObj _max;
+        BSONObj _shardKeyPattern;
 
         // we need the lock in case there is a malicious _migrateClone for example
         // even though it shouldn't be needed under normal operation
@@ -585,8 +608,8 @@ namespace mongo {
     } migrateFromStatus;
 
     struct MigrateStatusHolder {
-        MigrateStatusHolder( string ns , const BSONObj& min , const BSONObj& max ) {
-            migrateFromStatus.start( ns , min , max );
+        MigrateStatusHolder( string ns , const BSONObj& min , const BSONObj& max , const BSONObj& shardKeyPattern ) {
+            migrateFromStatus.start( ns , min , max , shardKeyPattern );
         }
         ~MigrateStatusHolder() {
             migrateFromStatus.done();
@@ -804,9 +827,14 @@ namespace mongo {
 
             ShardChunkVersion maxVersion;
             string myOldShard;
+            BSONObj shardKeyPattern;
             {
                 ScopedDbConnection conn( shardingState.getConfigServer() );
 
+                BSONObj collection = conn->findOne( ShardNS::collection , BSON( "_id" << ns ) );
+                if ( collection["key"].isABSONObj() )
+                    shardKeyPattern = collection["key"].Obj().getOwned();
+
                 BSONObj x = conn->findOne( ShardNS::chunk , Query( BSON( "ns" << ns ) ).sort( BSON( "lastmod" << -1 ) ) );
                 maxVersion = x["lastmod"];
 
@@ -862,7 +890,7 @@ namespace mongo {
             timing.done(2);
 
             // 3.
-            MigrateStatusHolder statusHolder( ns , min , max );
+            MigrateStatusHolder statusHolder( ns , min , max , shardKeyPattern );
             {
                 // this gets a read lock, so we know we have a checkpoint for mods
                 if ( ! migrateFromStatus.storeCurrentLocs( maxChunkSize , errmsg , result ) )
@@ -875,6 +903,7 @@ namespace mongo {
                                                     "from" << from <<
                                                     "min" << min <<
                                                     "max" << max <<
+                                                    "shardKeyPattern" << shardKeyPattern <<
                                                     "configServer" << configServer.modelServer()
                                                   ) ,
                                               res );
@@ -1158,6 +1187,7 @@ namespace mongo {
                 c.ns = ns;
                 c.min = min.getOwned();
                 c.max = max.getOwned();
+                c.shardKeyPattern = shardKeyPattern;
                 ClientCursor::find( ns , c.initial );
                 if ( c.initial.size() ) {
                     log() << "forking for cleaning up chunk data" << migrateLog;
@@ -1270,7 +1300,7 @@ namespace mongo {
                 // 2. delete any data already in range
                 writelock lk( ns );
                 RemoveSaver rs( "moveChunk" , ns , "preCleanup" );
-                long long num = Helpers::removeRange( ns , min , max , true , false , cmdLine.moveParanoia ? &rs : 0 );
+                long long num = Helpers::removeRange( ns , min , max , true , false , cmdLine.moveParanoia ? &rs : 0 , shardKeyIndex( shardKeyPattern ) );
                 if ( num )
                     warning() << "moveChunkCmd deleted data already in chunk # objects: " << num << migrateLog;
 
@@ -1296,16 +1326,29 @@ namespace mongo {
                     BSONObj arr = res["objects"].Obj();
                     int thisTime = 0;
 
+                    // plain inserts, logged as a group, with the write lock taken once per run
+                    // of documents rather than once per document.  the group is declared inside
+                    // the lock, so if a clone throws, what it holds is logged before the lock goes
                     BSONObjIterator i( arr );
                     while( i.more() ) {
-                        BSONObj o = i.next().Obj();
-                        {
-                            writelock lk( ns );
-                            Helpers::upsert( ns , o );
+                        writelock lk( ns );
+                        Client::Context ctx( ns );
+                        OpLogGroup group( "i" , ns.c_str() );
+
+                        for ( int n=0; n<CloneInsertRun && i.more(); n++ ) {
+                            BSONObj o = i.next().Obj();
+                            cloneInsert( o , group );
+                            thisTime++;
+                            numCloned++;
+                            clonedBytes += o.objsize();
+
+                            if ( getDur().aCommitIsNeeded() ) {
+                                group.flush();
+                                getDur().commitIfNeeded();
+                            }
                         }
-                        thisTime++;
-                        numCloned++;
-                        clonedBytes += o.objsize();
+
+                        group.flush();
                     }
 
                     if ( thisTime == 0 )
@@ -1313,6 +1356,8 @@ namespace mongo {
                 }
 
                 timing.done(3);
+                timing.count( "clonedDocs" , numCloned );
+                timing.count( "clonedBytes" , clonedBytes );
             }
 
             // if running on a replicated system, we'll need to flush the docs we cloned to the secondaries
@@ -1364,6 +1409,7 @@ namespace mongo {
                 }
 
                 timing.done(4);
+                timing.count( "catchupOps" , numCatchup );
             }
 
             { 
@@ -1413,6 +1459,7 @@ namespace mongo {
                 }
 
                 timing.done(5);
+                timing.count( "steadyOps" , numSteady );
             }
 
             state = DONE;
@@ -1442,6 +1489,26 @@ namespace mongo {
 
         }
 
+        /**
+         * inserts a cloned document.  the range was emptied before cloning, so the only way
+         * the insert can fail on a duplicate is an _id that is already used outside the
+         * range; that document gets the upsert the clone always did.  the group is flushed
+         * first, so the oplog keeps the order of the inserts and the upsert.
+         */
+        void cloneInsert( BSONObj o , OpLogGroup& group ) {
+            try {
+                theDataFileMgr.insertWithObjMod( ns.c_str() , o );
+            }
+            catch ( UserException& e ) {
+                if ( e.getCode() != 11000 )
+                    throw;
+                group.flush();
+                Helpers::upsert( ns , o );
+                return;
+            }
+            group.add( o );
+        }
+
         bool apply( const BSONObj& xfer , ReplTime* lastOpApplied ) {
             ReplTime dummy;
             if ( lastOpApplied == NULL ) {
@@ -1449,6 +1516,7 @@ namespace mongo {
             }
 
             bool didAnything = false;
+            long long numOps = 0;
 
             if ( xfer["deleted"].isABSONObj() ) {
                 writelock lk(ns);
@@ -1463,7 +1531,7 @@ namespace mongo {
                     // do not apply deletes if they do not belong to the chunk being migrated
                     BSONObj fullObj;
                     if ( Helpers::findById( cc() , ns.c_str() , id, fullObj ) ) {
-                        if ( ! isInRange( fullObj , min , max ) ) {
+                        if ( ! isInRange( fullObj , min , max , shardKeyPattern ) ) {
                             log() << "not applying out of range deletion: " << fullObj << migrateLog;
 
                             continue;
@@ -1474,6 +1542,7 @@ namespace mongo {
 
                     *lastOpApplied = cx.getClient()->getLastOp().asDate();
                     didAnything = true;
+                    numOps++;
                 }
             }
 
@@ -1489,9 +1558,15 @@ namespace mongo {
 
                     *lastOpApplied = cx.getClient()->getLastOp().asDate();
                     didAnything = true;
+                    numOps++;
                 }
             }
 
+            if ( state == CATCHUP )
+                numCatchup += numOps;
+            else
+                numSteady += numOps;
+
             return didAnything;
         }
 
@@ -1574,6 +1649,10 @@ namespace mongo {
 
         BSONObj min;
         BSONObj max;
+        BSONObj shardKeyPattern;
+
+        // cloned documents are inserted with one write lock per run of this many
+        static const int CloneInsertRun = 100;
 
         long long numCloned;
         long long clonedBytes;
@@ -1627,6 +1706,8 @@ namespace mongo {
             migrateStatus.from = cmdObj["from"].String();
             migrateStatus.min = cmdObj["min"].Obj().getOwned();
             migrateStatus.max = cmdObj["max"].Obj().getOwned();
+            // not sent by older versions, which only have ascending shard keys
+            migrateStatus.shardKeyPattern = cmdObj["shardKeyPattern"].isABSONObj() ? cmdObj["shardKeyPattern"].Obj().getOwned() : BSONObj();
 
             boost::thread m( migrateThread );
 
@@ -1678,12 +1759,12 @@ namespace mongo {
             BSONObj min = BSON( "x" << 1 );
             BSONObj max = BSON( "x" << 5 );
 
-            assert( ! isInRange( BSON( "x" << 0 ) , min , max ) );
-            assert( isInRange( BSON( "x" << 1 ) , min , max ) );
-            assert( isInRange( BSON( "x" << 3 ) , min , max ) );
-            assert( isInRange( BSON( "x" << 4 ) , min , max ) );
-            assert( ! isInRange( BSON( "x" << 5 ) , min , max ) );
-            assert( ! isInRange( BSON( "x" << 6 ) , min , max ) );
+            assert( ! isInRange( BSON( "x" << 0 ) , min , max , BSONObj() ) );
+            assert( isInRange( BSON( "x" << 1 ) , min , max , BSONObj() ) );
+            assert( isInRange( BSON( "x" << 3 ) , min , max , BSONObj() ) );
+            assert( isInRange( BSON( "x" << 4 ) , min , max , BSONObj() ) );
+            assert( ! isInRange( BSON( "x" << 5 ) , min , max , BSONObj() ) );
+            assert( ! isInRange( BSON( "x" << 6 ) , min , max , BSONObj() ) );
 
             LOG(1) << "isInRangeTest passed" << migrateLog;
         }
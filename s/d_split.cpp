@@ -29,11 +29,13 @@
 
 #include "../client/connpool.h"
 #include "../client/distlock.h"
+#include "../util/background.h"
 #include "../util/timer.h"
 
 #include "chunk.h" // for static genID only
 #include "config.h"
 #include "d_logic.h"
+#include "shardkey.h"
 
 namespace mongo {
 
@@ -236,6 +238,127 @@ namespace mongo {
         }
     } cmdCheckShardingIndex;
 
+    /**
+     * Estimates ranks and keys of an index from the shape of its btree alone.  Every subtree under a
+     * bucket is taken to hold as many keys as its siblings, which buckets split in half keep roughly
+     * true.  Then a key's rank, as a fraction of all the index's keys, comes from one descent, and so
+     * does the key at a given rank: a few bucket reads instead of a walk over the keys in between.
+     */
+    template< class V >
+    class BtreeSampler {
+    public:
+        BtreeSampler( const IndexDetails& idx ) : _head( idx.head ) , _order( Ordering::make( idx.keyPattern() ) ) {}
+
+        /** @return the fraction of the index's keys that come before 'key' */
+        double rank( const BSONObj& key ) const {
+            double lo = 0;
+            double width = 1;
+            DiskLoc loc = _head;
+            while ( ! loc.isNull() ) {
+                const BtreeBucket<V>* b = loc.btree<V>();
+                const int n = b->getN();
+
+                // first key not less than 'key'
+                int l = 0;
+                int r = n;
+                while ( l < r ) {
+                    int m = ( l + r ) / 2;
+                    if ( b->keyNode( m ).key.toBson().woCompare( key , _order , false ) < 0 )
+                        l = m + 1;
+                    else
+                        r = m;
+                }
+
+                DiskLoc child = l < n ? DiskLoc( b->keyNode( l ).prevChildBucket ) : b->getNextChild();
+                if ( child.isNull() ) {
+                    // a leaf's keys share its part evenly
+                    return n ? lo + width * l / n : lo;
+                }
+
+                width /= n + 1;
+                lo += width * l;
+                loc = child;
+            }
+            return lo;
+        }
+
+        /** @return the key at rank 'fraction' of the index, in index format, or BSONObj() if there's none */
+        BSONObj keyAt( double fraction ) const {
+            BSONObj found;
+            DiskLoc loc = _head;
+            while ( ! loc.isNull() ) {
+                const BtreeBucket<V>* b = loc.btree<V>();
+                const int n = b->getN();
+                if ( n == 0 )
+                    return found;
+
+                if ( DiskLoc( b->keyNode( 0 ).prevChildBucket ).isNull() ) {
+                    // a leaf
+                    const int i = std::min( (int)( fraction * n ) , n - 1 );
+                    for ( int d = 0; d < n; d++ ) {
+                        if ( i + d < n && b->isUsed( i + d ) )
+                            return b->keyNode( i + d ).key.toBson().getOwned();
+                        if ( i - d >= 0 && b->isUsed( i - d ) )
+                            return b->keyNode( i - d ).key.toBson().getOwned();
+                    }
+                    return found;
+                }
+
+                const double pos = fraction * ( n + 1 );
+                const int i = std::min( (int)pos , n );
+                fraction = pos - i;
+
+                // the key next to the subtree stands in if the leaf under it has only unused keys
+                const int next = i < n ? i : n - 1;
+                if ( b->isUsed( next ) )
+                    found = b->keyNode( next ).key.toBson().getOwned();
+
+                loc = i < n ? DiskLoc( b->keyNode( i ).prevChildBucket ) : b->getNextChild();
+            }
+            return found;
+        }
+
+    private:
+        const DiskLoc _head;
+        const Ordering _order;
+    };
+
+    /**
+     * splitVector's sampling mode: the split points the index walk would pick, every 'keyCount'-th key
+     * in [min,max) or the median if 'force', estimated with a BtreeSampler.  'recCount' stands for the
+     * number of keys in the index, which holds for indexes that aren't multikey.
+     */
+    template< class V >
+    static void sampleSplitKeys( const IndexDetails& idx , const BSONObj& min , const BSONObj& max , long long recCount ,
+                                 long long keyCount , bool force , long long maxSplitPoints , vector<BSONObj>& splitKeys ) {
+        BtreeSampler<V> sampler( idx );
+        const double from = sampler.rank( min );
+        const double keysInRange = ( sampler.rank( max ) - from ) * recCount;
+
+        const double step = force ? keysInRange / 2 : keyCount;
+        if ( step < 1 )
+            return;
+
+        BSONObj last = min;
+        for ( double k = step; k < keysInRange; k += step ) {
+            if ( maxSplitPoints && (long long)splitKeys.size() >= maxSplitPoints )
+                break;
+            if ( force && ! splitKeys.empty() )
+                break;
+
+            BSONObj key = sampler.keyAt( from + k / recCount );
+
+            // estimates can land on a key more than once; keep the points distinct and inside the chunk
+            if ( key.isEmpty() ||
+                 key.woCompare( last , BSONObj() , false ) <= 0 ||
+                 key.woCompare( max , BSONObj() , false ) >= 0 )
+                continue;
+
+            splitKeys.push_back( key.replaceFieldNames( idx.keyPattern() ).clientReadable() );
+            last = key;
+        }
+    }
+
     class SplitVector : public Command {
     public:
         SplitVector() : Command( "splitVector" , false ) {}
@@ -251,6 +374,7 @@ namespace mongo {
                  "  \n"
                  "  { splitVector : \"blog.post\" , keyPattern:{x:1} , min:{x:10} , max:{x:20}, force: true }\n"
                  "  'force' will produce one split point even if data is small; defaults to false\n"
+                 "  'sample' estimates the split points from the btree's buckets instead of walking every key\n"
                  "NOTE: This command may take a while to run";
         }
 
@@ -369,6 +493,28 @@ namespace mongo {
                     keyCount = maxChunkObjects;
                 }
                 
+                //
+                // 2.a With 'sample', estimate the split points from the shape of the btree, in a few bucket
+                //     reads per split point. If the keys are too few and repeated for the estimates to find
+                //     distinct points, walk the index after all.
+                //
+
+                if ( jsobj["sample"].trueValue() && ! d->isMultikey( d->idxNo( *idx ) ) ) {
+                    Timer timer;
+                    if ( idx->version() == 1 )
+                        sampleSplitKeys<V1>( *idx , min , max , recCount , keyCount , force , maxSplitPoints , splitKeys );
+                    else
+                        sampleSplitKeys<V0>( *idx , min , max , recCount , keyCount , force , maxSplitPoints , splitKeys );
+
+                    if ( ! splitKeys.empty() ) {
+                        LOG(1) << "sampled " << splitKeys.size() << " split points for " << ns << " " << min << " -->> " << max
+                               << " in " << timer.millis() << "ms" << endl;
+                        result.append( "splitKeys" , splitKeys );
+                        result.appendBool( "sampled" , true );
+                        return true;
+                    }
+                }
+
                 //
                 // 2. Traverse the index and add the keyCount-th key to the result vector. If that key
                 //    appeared in the vector before, we omit it. The invariant here is that all the
@@ -827,4 +973,240 @@ namespace mongo {
         }
     } cmdSplitChunk;
 
+    /**
+     * Splits chunks from the shard that holds them.  Every write reaching this shard is counted against
+     * its chunk, whichever mongos sent it, and the index is only looked at once a chunk has taken in a
+     * fifth of the max chunk size in all -- not once per mongos that happened to see that much of it.
+     * The look is the bounded splitVector mongos would do: it stops at the chunk's halfway key, which
+     * is where a full chunk gets split.
+     */
+    class AutoSplitter : public BackgroundJob {
+    public:
+        AutoSplitter() : _mutex( "AutoSplitter" ) , _started( false ) , _checks(0) , _splits(0) {}
+
+        string name() const { return "AutoSplitter"; }
+
+        void noteWrite( const string& ns , const BSONObj& obj , int bytes ) {
+            ShardChunkManagerPtr p = shardingState.getShardChunkManager( ns );
+            if ( ! p )
+                return;
+
+            // an update that doesn't pin down the whole key can't be put on a chunk
+            BSONObjIterator i( p->getKey() );
+            while ( i.more() ) {
+                BSONElement e = obj.getFieldDotted( i.next().fieldName() );
+                if ( e.eoo() || e.getGtLtOp() != BSONObj::Equality )
+                    return;
+            }
+
+            BSONObj min;
+            BSONObj max;
+            if ( ! p->getChunkContaining( obj , &min , &max ) )
+                return;
+
+            scoped_lock lk( _mutex );
+            if ( ! _started ) {
+                _started = true;
+                go();
+            }
+
+            ChunkWrites& w = _writes[ns][min];
+            w.bytes += bytes;
+            if ( w.queued || w.bytes < _threshold( min , max ) )
+                return;
+
+            w.queued = true;
+            _queue.push_back( SplitCandidate( ns , min , max ) );
+        }
+
+        void appendInfo( BSONObjBuilder& b ) {
+            scoped_lock lk( _mutex );
+            b.appendNumber( "checks" , _checks );
+            b.appendNumber( "splits" , _splits );
+            b.appendNumber( "queued" , (long long)_queue.size() );
+        }
+
+        void run() {
+            Client::initThread( name().c_str() );
+            Client& client = cc();
+            client.getAuthenticationInfo()->authorize( "admin" , internalSecurity.user );
+
+            int idleSecs = 0;
+            while ( ! inShutdown() ) {
+                // the chunk size can be changed through any mongos
+                if ( idleSecs % 30 == 0 ) {
+                    try {
+                        Chunk::refreshChunkSize();
+                    }
+                    catch ( DBException& e ) {
+                        LOG(1) << "auto split couldn't refresh the chunk size: " << e.toString() << endl;
+                    }
+                }
+
+                vector<SplitCandidate> todo;
+                {
+                    scoped_lock lk( _mutex );
+                    todo.swap( _queue );
+                }
+
+                if ( todo.empty() ) {
+                    idleSecs++;
+                    sleepsecs( 1 );
+                    continue;
+                }
+                idleSecs = 0;
+
+                for ( unsigned i = 0; i < todo.size() && ! inShutdown(); i++ ) {
+                    try {
+                        _check( todo[i] );
+                    }
+                    catch ( DBException& e ) {
+                        warning() << "auto split check of " << todo[i].ns << " " << todo[i].min << " -->> " << todo[i].max
+                                  << " failed: " << e.toString() << endl;
+                    }
+
+                    // the chunk counts from scratch, split or not
+                    scoped_lock lk( _mutex );
+                    _writes[todo[i].ns].erase( todo[i].min );
+                }
+            }
+
+            client.shutdown();
+        }
+
+    private:
+
+        struct ChunkWrites {
+            ChunkWrites() : bytes(0) , queued(false) {}
+            long long bytes;
+            bool queued;
+        };
+
+        struct SplitCandidate {
+            SplitCandidate( const string& a_ns , const BSONObj& a_min , const BSONObj& a_max )
+                : ns( a_ns ) , min( a_min ) , max( a_max ) {}
+            string ns;
+            BSONObj min;
+            BSONObj max;
+        };
+
+        /** as in Chunk::splitIfShould(), the chunks at either end are checked a bit earlier */
+        static long long _threshold( const BSONObj& min , const BSONObj& max ) {
+            long long threshold = Chunk::MaxChunkSize;
+            if ( min.firstElement().type() == MinKey || max.firstElement().type() == MaxKey )
+                threshold = threshold * 9 / 10;
+            return threshold / 5;
+        }
+
+        void _check( const SplitCandidate& c ) {
+            const string shardName = shardingState.getShardName();
+            ShardChunkManagerPtr p = shardingState.getShardChunkManager( c.ns );
+            if ( shardName.empty() || ! p )
+                return;
+
+            const BSONObj keyPattern = p->getKey();
+            ShardKeyPattern skp( keyPattern );
+
+            {
+                scoped_lock lk( _mutex );
+                _checks++;
+            }
+
+            DBDirectClient conn;
+
+            // at most two split points, sampled from the index's buckets
+            BSONObj res;
+            BSONObjBuilder cmd;
+            cmd.append( "splitVector" , c.ns );
+            cmd.append( "keyPattern" , keyPattern );
+            cmd.append( "min" , c.min );
+            cmd.append( "max" , c.max );
+            cmd.append( "maxChunkSizeBytes" , Chunk::MaxChunkSize );
+            cmd.append( "maxSplitPoints" , 2 );
+            cmd.append( "maxChunkObjects" , Chunk::MaxObjectPerChunk );
+            cmd.appendBool( "sample" , true );
+            if ( ! conn.runCommand( "admin" , cmd.obj() , res ) ) {
+                LOG(1) << "auto split check of " << c.ns << " failed: " << res << endl;
+                return;
+            }
+
+            vector<BSONElement> candidates = res["splitKeys"].Array();
+            if ( candidates.size() <= 1 ) {
+                // no split point means there isn't enough data to split on, one means the chunk
+                // is between half and full
+                LOG(1) << "chunk not full enough to trigger auto-split " << c.ns << " " << c.min << " -->> " << c.max << endl;
+                return;
+            }
+            BSONObj splitPoint = candidates[0].Obj().getOwned();
+
+            // as in Chunk::singleSplit(), the chunks at the ends of the key range are likely to take
+            // more inserts, so they're split at their extreme key instead
+            if ( ! skp.isHashed() ) {
+                if ( skp.isGlobalMin( c.min ) )
+                    splitPoint = _extremeKey( conn , c.ns , skp , 1 );
+                else if ( skp.isGlobalMax( c.max ) )
+                    splitPoint = _extremeKey( conn , c.ns , skp , -1 );
+            }
+
+            if ( splitPoint.isEmpty() || splitPoint.woCompare( c.min ) == 0 || splitPoint.woCompare( c.max ) == 0 ) {
+                log() << "want to split chunk, but can't find split point chunk " << c.ns << " " << c.min << " -->> " << c.max
+                      << " got: " << ( splitPoint.isEmpty() ? "<empty>" : splitPoint.toString() ) << endl;
+                return;
+            }
+
+            BSONObjBuilder split;
+            split.append( "splitChunk" , c.ns );
+            split.append( "keyPattern" , keyPattern );
+            split.append( "min" , c.min );
+            split.append( "max" , c.max );
+            split.append( "from" , shardName );
+            split.append( "splitKeys" , BSON_ARRAY( splitPoint ) );
+            split.append( "shardId" , Chunk::genID( c.ns , c.min ) );
+            split.append( "configdb" , shardingState.getConfigServer() );
+
+            res = BSONObj();
+            if ( ! conn.runCommand( "admin" , split.obj() , res ) ) {
+                warning() << "auto split of " << c.ns << " " << c.min << " -->> " << c.max << " failed: " << res << endl;
+                return;
+            }
+
+            log() << "autosplitted " << c.ns << " chunk: " << c.min << " -->> " << c.max << " on: " << splitPoint << endl;
+
+            scoped_lock lk( _mutex );
+            _splits++;
+        }
+
+        static BSONObj _extremeKey( DBDirectClient& conn , const string& ns , const ShardKeyPattern& skp , int sort ) {
+            BSONObjBuilder b;
+            BSONForEach( e , skp.key() ) {
+                b.append( e.fieldName() , sort * e.number() );
+            }
+
+            BSONObj end = conn.findOne( ns , Query().sort( b.obj() ) );
+            if ( end.isEmpty() )
+                return BSONObj();
+            return skp.extractKey( end );
+        }
+
+        // protects the state below
+        mongo::mutex _mutex;
+        bool _started;
+
+        // bytes written to each chunk since its last check, by ns and chunk min
+        map< string , map< BSONObj , ChunkWrites , BSONObjCmp > > _writes;
+        vector<SplitCandidate> _queue;
+
+        long long _checks;
+        long long _splits;
+
+    } autoSplitter;
+
+    void noteWriteForAutoSplit( const string& ns , const BSONObj& obj , int bytes ) {
+        autoSplitter.noteWrite( ns , obj , bytes );
+    }
+
+    void appendAutoSplitInfo( BSONObjBuilder& b ) {
+        autoSplitter.appendInfo( b );
+    }
+
 }  // namespace mongo
@@ -77,6 +77,11 @@ namespace mongo {
         msgasserted( 13298 , ss.str() );
     }
 
+    string ShardingState::getShardName() {
+        scoped_lock lk(_mutex);
+        return _shardName;
+    }
+
     void ShardingState::gotShardHost( string host ) {
         scoped_lock lk(_mutex);
         size_t slash = host.find( '/' );
@@ -107,6 +112,7 @@ namespace mongo {
         _shardName.clear();
         _shardHost.clear();
         _chunks.clear();
+        _generation++;
     }
 
     // TODO we shouldn't need three ways for checking the version. Fix this.
@@ -154,6 +160,7 @@ namespace mongo {
 
         ShardChunkManagerPtr cloned( p->cloneMinus( min , max , version ) );
         _chunks[ns] = cloned;
+        _generation++;
     }
 
     void ShardingState::undoDonateChunk( const string& ns , const BSONObj& min , const BSONObj& max , ShardChunkVersion version ) {
@@ -163,6 +170,7 @@ namespace mongo {
         assert( it != _chunks.end() ) ;
         ShardChunkManagerPtr p( it->second->clonePlus( min , max , version ) );
         _chunks[ns] = p;
+        _generation++;
     }
 
     void ShardingState::splitChunk( const string& ns , const BSONObj& min , const BSONObj& max , const vector<BSONObj>& splitKeys ,
@@ -173,12 +181,14 @@ namespace mongo {
         assert( it != _chunks.end() ) ;
         ShardChunkManagerPtr p( it->second->cloneSplit( min , max , splitKeys , version ) );
         _chunks[ns] = p;
+        _generation++;
     }
 
     void ShardingState::resetVersion( const string& ns ) {
         scoped_lock lk( _mutex );
 
         _chunks.erase( ns );
+        _generation++;
     }
 
     bool ShardingState::trySetVersion( const string& ns , ConfigVersion& version /* IN-OUT */ ) {
@@ -219,6 +229,7 @@ namespace mongo {
             ChunkManagersMap::const_iterator it = _chunks.find( ns );
             if ( it == _chunks.end() || p->getVersion() >= it->second->getVersion() ) {
                 _chunks[ns] = p;
+                _generation++;
             }
 
             ShardChunkVersion oldVersion = version;
@@ -248,6 +259,12 @@ namespace mongo {
             bb.done();
         }
 
+        {
+            BSONObjBuilder bb( b.subobjStart( "autoSplit" ) );
+            appendAutoSplitInfo( bb );
+            bb.done();
+        }
+
     }
 
     bool ShardingState::needShardChunkManager( const string& ns ) const {
@@ -311,6 +328,16 @@ namespace mongo {
 
     void ShardedConnectionInfo::setVersion( const string& ns , const ConfigVersion& version ) {
         _versions[ns] = version;
+        _okAt.erase( ns );
+    }
+
+    bool ShardedConnectionInfo::versionOkAt( const string& ns , unsigned generation ) const {
+        NSGenerationMap::const_iterator it = _okAt.find( ns );
+        return it != _okAt.end() && it->second == generation;
+    }
+
+    void ShardedConnectionInfo::noteVersionOk( const string& ns , unsigned generation ) {
+        _okAt[ns] = generation;
     }
 
     void ShardedConnectionInfo::addHook() {
@@ -490,6 +517,8 @@ namespace mongo {
             // Handle initial shard connection
             if( cmdObj["version"].eoo() && cmdObj["init"].trueValue() ){
                 result.append( "initialized", true );
+                // lets mongos know it needn't look for chunks to split here
+                result.appendBool( "autoSplit" , true );
                 return true;
             }
 
@@ -683,28 +712,8 @@ namespace mongo {
      * @ return true if not in sharded mode
                      or if version for this client is ok
      */
-    bool shardVersionOk( const string& ns , string& errmsg ) {
-        if ( ! shardingState.enabled() )
-            return true;
-
-        if ( ! isMasterNs( ns.c_str() ) )  {
-            // right now connections to secondaries aren't versioned at all
-            return true;
-        }
-
-        ShardedConnectionInfo* info = ShardedConnectionInfo::get( false );
-
-        if ( ! info ) {
-            // this means the client has nothing sharded
-            // so this allows direct connections to do whatever they want
-            // which i think is the correct behavior
-            return true;
-        }
-
-        if ( info->inForceVersionOkMode() ) {
-            return true;
-        }
-
+    /** compares the connection's version for 'ns' with this shard's */
+    static bool _shardVersionOk( ShardedConnectionInfo* info , const string& ns , string& errmsg ) {
         // TODO
         //   all collections at some point, be sharded or not, will have a version (and a ShardChunkManager)
         //   for now, we remove the sharding state of dropped collection
@@ -747,6 +756,41 @@ namespace mongo {
         return false;
     }
 
+    bool shardVersionOk( const string& ns , string& errmsg ) {
+        if ( ! shardingState.enabled() )
+            return true;
+
+        if ( ! isMasterNs( ns.c_str() ) )  {
+            // right now connections to secondaries aren't versioned at all
+            return true;
+        }
+
+        ShardedConnectionInfo* info = ShardedConnectionInfo::get( false );
+
+        if ( ! info ) {
+            // this means the client has nothing sharded
+            // so this allows direct connections to do whatever they want
+            // which i think is the correct behavior
+            return true;
+        }
+
+        if ( info->inForceVersionOkMode() ) {
+            return true;
+        }
+
+        // the generation is read before the versions are compared, so a change in between makes
+        // the next request compare them again
+        const unsigned generation = shardingState.getGeneration();
+        if ( info->versionOkAt( ns , generation ) )
+            return true;
+
+        if ( ! _shardVersionOk( info , ns , errmsg ) )
+            return false;
+
+        info->noteVersionOk( ns , generation );
+        return true;
+    }
+
     void ShardingConnectionHook::onHandedOut( DBClientBase * conn ) {
         // no-op for mongod
     }
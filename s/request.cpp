@@ -57,6 +57,7 @@ namespace mongo {
         if ( _didInit )
             return;
         _didInit = true;
+        uassert( 15934, "acknowledged writes (writeack) are not supported through mongos yet", _m.operation() != dbWriteAck );
         reset();
     }
 
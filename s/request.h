@@ -44,7 +44,7 @@ namespace mongo {
             return _m.operation();
         }
         bool expectResponse() const {
-            return op() == dbQuery || op() == dbGetMore;
+            return op() == dbQuery || op() == dbGetMore || op() == dbWriteAck;
         }
         bool isCommand() const;
 
@@ -71,16 +71,69 @@ namespace mongo {
         void reset( DBClientBase * conn ) {
             scoped_lock lk( _mutex );
             _map.erase( conn );
+            _resets++;
         }
 
+        /** @return a number that changes whenever a connection's versions are forgotten */
+        unsigned getResets() const { return _resets.get(); }
+
         // protects _map
         mongo::mutex _mutex;
 
         // a map from a connection into ChunkManager's sequence number for each namespace
         map<DBClientBase*, map<string,unsigned long long> > _map;
 
+        AtomicUInt _resets;
+
     } connectionShardStatus;
 
+    /**
+     * the connections this thread found current for a namespace, and the routing epoch at which it did.
+     * while neither the epoch nor the resets of connectionShardStatus moved, checking the same
+     * connection and namespace again would find it current too, so that takes no lock at all
+     */
+    class VersionCheckCache {
+    public:
+        VersionCheckCache() : _resets( 0 ) {}
+
+        bool isCurrent( DBClientBase * conn , const string& ns , unsigned epoch , unsigned resets ) const {
+            if ( resets != _resets )
+                return false;
+            Checked::const_iterator i = _checked.find( conn );
+            if ( i == _checked.end() )
+                return false;
+            map<string,unsigned>::const_iterator j = i->second.find( ns );
+            return j != i->second.end() && j->second == epoch;
+        }
+
+        void noteCurrent( DBClientBase * conn , const string& ns , unsigned epoch , unsigned resets ) {
+            if ( resets != _resets ) {
+                // a reset connection's address may be reused by another one
+                _checked.clear();
+                _resets = resets;
+            }
+            _checked[conn][ns] = epoch;
+        }
+
+        static VersionCheckCache * get() {
+            VersionCheckCache * c = _tl.get();
+            if ( ! c ) {
+                c = new VersionCheckCache();
+                _tl.reset( c );
+            }
+            return c;
+        }
+
+    private:
+        typedef map<DBClientBase*, map<string,unsigned> > Checked;
+        Checked _checked;
+        unsigned _resets;
+
+        static boost::thread_specific_ptr<VersionCheckCache> _tl;
+    };
+
+    boost::thread_specific_ptr<VersionCheckCache> VersionCheckCache::_tl;
+
     void resetShardVersion( DBClientBase * conn ) {
         connectionShardStatus.reset( conn );
     }
@@ -146,6 +199,9 @@ namespace mongo {
 
         LOG(3) << "initial sharding result : " << result << endl;
 
+        if ( ok && result["autoSplit"].trueValue() )
+            Chunk::setShardSplitsChunks( conn->getServerAddress() );
+
         return ok;
 
     }
@@ -167,7 +223,16 @@ namespace mongo {
      * @return true if had to do something
      */
     bool checkShardVersion( DBClientBase& conn_in , const string& ns , bool authoritative , int tryNumber ) {
-        // TODO: cache, optimize, etc...
+        DBClientBase* conn = getVersionable( &conn_in );
+        assert(conn); // errors thrown above
+
+        // the common case: nothing changed since this thread last found the connection current.
+        // both numbers are read before anything else, so a change after this is seen next time
+        const unsigned epoch = ChunkManager::getRoutingEpoch();
+        const unsigned resets = connectionShardStatus.getResets();
+        VersionCheckCache * cache = VersionCheckCache::get();
+        if ( ! authoritative && cache->isCurrent( conn , ns , epoch , resets ) )
+            return false;
 
         WriteBackListener::init( conn_in );
 
@@ -175,9 +240,6 @@ namespace mongo {
         if ( ! conf )
             return false;
 
-        DBClientBase* conn = getVersionable( &conn_in );
-        assert(conn); // errors thrown above
-
         unsigned long long officialSequenceNumber = 0;
 
         ChunkManagerPtr manager;
@@ -193,6 +255,7 @@ namespace mongo {
         // (ie., last time we issued the setShardVersions below)
         unsigned long long sequenceNumber = connectionShardStatus.getSequence(conn,ns);
         if ( sequenceNumber == officialSequenceNumber ) {
+            cache->noteCurrent( conn , ns , epoch , resets );
             return false;
         }
 
@@ -220,6 +283,7 @@ namespace mongo {
             // success!
             LOG(1) << "      setShardVersion success: " << result << endl;
             connectionShardStatus.setSequence( conn , ns , officialSequenceNumber );
+            cache->noteCurrent( conn , ns , epoch , resets );
             return true;
         }
 
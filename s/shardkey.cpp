@@ -19,12 +19,13 @@
 #include "pch.h"
 #include "chunk.h"
 #include "../db/jsobj.h"
+#include "../db/hasher.h"
 #include "../util/unittest.h"
 #include "../util/timer.h"
 
 namespace mongo {
 
-    ShardKeyPattern::ShardKeyPattern( BSONObj p ) : pattern( p.getOwned() ) {
+    ShardKeyPattern::ShardKeyPattern( BSONObj p ) : pattern( p.getOwned() ) , _hashed( isHashedPattern( p ) ) {
         pattern.getFieldNames(patternfields);
 
         BSONObjBuilder min;
@@ -64,6 +65,20 @@ namespace mongo {
         return true;
     }
 
+    bool ShardKeyPattern::isHashedPattern( const BSONObj& pattern ) {
+        BSONElement e = pattern.firstElement();
+        return pattern.nFields() == 1 && e.type() == String && str::equals( e.valuestr() , "hashed" );
+    }
+
+    BSONObj ShardKeyPattern::hashedKey( const BSONObj& key ) {
+        BSONElement e = key.firstElement();
+        if ( e.type() == MinKey || e.type() == MaxKey )
+            return key;
+        BSONObjBuilder b;
+        b.append( e.fieldName() , BSONElementHasher::hash64( e ) );
+        return b.obj();
+    }
+
     bool ShardKeyPattern::isPrefixOf( const BSONObj& otherPattern ) const {
         BSONObjIterator a( pattern );
         BSONObjIterator b( otherPattern );
@@ -191,6 +206,23 @@ namespace mongo {
             assert( k.extractKey( fromjson("{a:1,sub:{b:2,c:3}}") ).binaryEqual(x) );
             assert( k.extractKey( fromjson("{sub:{b:2,c:3},a:1}") ).binaryEqual(x) );
         }
+        void hashedKeyTest() {
+            ShardKeyPattern k( fromjson("{a:'hashed'}") );
+            assert( k.isHashed() );
+            assert( ! ShardKeyPattern( BSON( "a" << 1 ) ).isHashed() );
+            assert( ! ShardKeyPattern::isHashedPattern( fromjson("{a:'hashed',b:1}") ) );
+
+            BSONObj h = k.chunkKey( k.extractKey( BSON( "z" << 1 << "a" << 5 ) ) );
+            assert( str::equals( h.firstElementFieldName() , "a" ) );
+            assert( h.firstElement().type() == NumberLong );
+            assert( h.firstElement().Long() == BSONElementHasher::hash64( BSON( "" << 5 ).firstElement() ) );
+            // numbers that compare equal land in the same chunk
+            assert( h.binaryEqual( k.chunkKey( BSON( "a" << 5.0 ) ) ) );
+
+            assert( k.chunkKey( k.globalMin() ).binaryEqual( k.globalMin() ) );
+            assert( k.chunkKey( k.globalMax() ).binaryEqual( k.globalMax() ) );
+        }
+
         void moveToFrontTest() {
             ShardKeyPattern sk (BSON("a" << 1 << "b" << 1));
 
@@ -256,6 +288,7 @@ namespace mongo {
             assert( k.compare(a,b) < 0 );
 
             testIsPrefixOf();
+            hashedKeyTest();
             // add middle multitype tests
 
             moveToFrontTest();
@@ -74,6 +74,28 @@ namespace mongo {
 
         BSONObj extractKey(const BSONObj& from) const;
 
+        /**
+         * hashed shard keys, { a : "hashed" }, partition the 64 bit hash of a instead of a itself,
+         * so monotonically increasing values still spread over all chunks.  chunk boundaries,
+         * split points and the shard key index all hold the hash.
+         */
+        bool isHashed() const { return _hashed; }
+
+        /**
+         * @param key a shard key as returned by extractKey
+         * @return the point in chunk space that key falls in: key itself, or its hash for hashed shard keys
+         */
+        BSONObj chunkKey( const BSONObj& key ) const { return _hashed ? hashedKey( key ) : key; }
+
+        static bool isHashedPattern( const BSONObj& pattern );
+
+        /**
+         * @param key { a : v }
+         * @return { a : NumberLong( hash(v) ) }, the same hash the hashed index keeps for v.
+         *         MinKey and MaxKey are kept so the global bounds stay the global bounds.
+         */
+        static BSONObj hashedKey( const BSONObj& key );
+
         bool partOfShardKey(const char* key ) const {
             return pattern.hasField(key);
         }
@@ -96,6 +118,7 @@ namespace mongo {
         BSONObj pattern;
         BSONObj gMin;
         BSONObj gMax;
+        bool _hashed;
 
         /* question: better to have patternfields precomputed or not?  depends on if we use copy constructor often. */
         set<string> patternfields;
@@ -123,7 +123,7 @@ namespace mongo {
 
         void _insert( Request& r , DbMessage& d, ChunkManagerPtr manager ) {
             const int flags = d.reservedField() | InsertOption_ContinueOnError; // ContinueOnError is always on when using sharding.
-            map<ChunkPtr, vector<BSONObj> > insertsForChunk; // Group bulk insert for appropriate shards
+            vector<BSONObj> objs;
             try {
                 while ( d.moreJSObjs() ) {
                     BSONObj o = d.nextJsObj();
@@ -147,49 +147,67 @@ namespace mongo {
                     }
 
                     // Many operations benefit from having the shard key early in the object
-                    o = manager->getShardKey().moveToFront(o);
-                    insertsForChunk[manager->findChunk(o)].push_back(o);
+                    objs.push_back( manager->getShardKey().moveToFront(o) );
                 }
-                for (map<ChunkPtr, vector<BSONObj> >::iterator it = insertsForChunk.begin(); it != insertsForChunk.end(); ++it) {
-                    ChunkPtr c = it->first;
-                    vector<BSONObj> objs = it->second;
-                    const int maxTries = 30;
 
-                    bool gotThrough = false;
-                    for ( int i=0; i<maxTries; i++ ) {
-                        try {
-                            LOG(4) << "  server:" << c->getShard().toString() << " bulk insert " << objs.size() << " documents" << endl;
-                            insert( c->getShard() , r.getns() , objs , flags);
+                // one bulk insert per shard, however many of its chunks the documents fall in.
+                // the inserts don't wait for a reply, so every shard is working on its part
+                // before we're done sending.  whatever a shard turned away for a stale version
+                // is routed again after a single reload of the chunk manager
+                const int maxTries = 30;
+                for ( int i=0; i<maxTries && ! objs.empty(); i++ ) {
+                    map<Shard, vector<BSONObj> > insertsForShard;
+                    map<ChunkPtr, int> bytesForChunk;
+                    for ( vector<BSONObj>::iterator it = objs.begin(); it != objs.end(); ++it ) {
+                        ChunkPtr c = manager->findChunk( *it );
+                        insertsForShard[c->getShard()].push_back( *it );
+                        bytesForChunk[c] += it->objsize();
+                    }
 
-                            int bytesWritten = 0;
-                            for (vector<BSONObj>::iterator vecIt = objs.begin(); vecIt != objs.end(); ++vecIt) {
-                                r.gotInsert(); // Record the correct number of individual inserts
-                                bytesWritten += (*vecIt).objsize();
-                            }
-                            if ( r.getClientInfo()->autoSplitOk() )
-                                c->splitIfShould( bytesWritten );
-                            gotThrough = true;
-                            break;
+                    vector<BSONObj> stale;
+                    for ( map<Shard, vector<BSONObj> >::iterator it = insertsForShard.begin(); it != insertsForShard.end(); ++it ) {
+                        const Shard& shard = it->first;
+                        vector<BSONObj>& shardObjs = it->second;
+                        try {
+                            LOG(4) << "  server:" << shard.toString() << " bulk insert " << shardObjs.size() << " documents" << endl;
+                            insert( shard , r.getns() , shardObjs , flags );
                         }
                         catch ( StaleConfigException& e ) {
                             int logLevel = i < ( maxTries / 2 );
-                            LOG( logLevel ) << "retrying bulk insert of " << objs.size() << " documents because of StaleConfigException: " << e << endl;
-                            r.reset();
+                            LOG( logLevel ) << "retrying bulk insert of " << shardObjs.size() << " documents because of StaleConfigException: " << e << endl;
+                            stale.insert( stale.end() , shardObjs.begin() , shardObjs.end() );
+                            continue;
+                        }
 
-                            manager = r.getChunkManager();
-                            if( ! manager ) {
-                                uasserted(14804, "collection no longer sharded");
-                            }
+                        for ( unsigned j=0; j<shardObjs.size(); j++ )
+                            r.gotInsert(); // Record the correct number of individual inserts
 
-                            unsigned long long old = manager->getSequenceNumber();
-                            
-                            LOG( logLevel ) << "  sequence number - old: " << old << " new: " << manager->getSequenceNumber() << endl;
+                        if ( r.getClientInfo()->autoSplitOk() ) {
+                            for ( map<ChunkPtr, int>::iterator c = bytesForChunk.begin(); c != bytesForChunk.end(); ++c ) {
+                                if ( c->first->getShard() == shard )
+                                    c->first->splitIfShould( c->second );
+                            }
                         }
-                        sleepmillis( i * 20 );
                     }
 
-                    assert( inShutdown() || gotThrough ); // not caught below
+                    objs.swap( stale );
+                    if ( objs.empty() )
+                        break;
+
+                    r.reset();
+
+                    unsigned long long old = manager->getSequenceNumber();
+                    manager = r.getChunkManager();
+                    if( ! manager ) {
+                        uasserted(14804, "collection no longer sharded");
+                    }
+
+                    LOG( i < ( maxTries / 2 ) ) << "  sequence number - old: " << old << " new: " << manager->getSequenceNumber() << endl;
+
+                    sleepmillis( i * 20 );
                 }
+
+                assert( inShutdown() || objs.empty() ); // not caught below
             } catch (const UserException&){
                 if (!d.moreJSObjs()){
                     throw;
@@ -198,6 +216,117 @@ namespace mongo {
             }
         }
 
+        /**
+         * sends a multi update or a remove to the shards whose chunks the query's shard key ranges
+         * reach.  when that's every shard of the collection the write is broadcast, with no version
+         * check.  a smaller set is only right for the chunks we know about, so every connection's
+         * version is checked before anything is sent, and a chunk that moved out of the set sends us
+         * back to reload and target again.  the shards all work on the write at once; getLastError
+         * collects from each of them.
+         * a shard whose version moved after that check writes the whole write back.  the others
+         * applied it already, and doing it again there would apply an $inc or a $push twice, so the
+         * replay goes to the shards the write reaches now that it wasn't routed to the first time,
+         * or, if we no longer know how it was routed, to the shard that wrote it back only
+         * @param shards the shards for 'query' on 'manager', updated on a retry
+         */
+        void _multiWrite( int op , Request& r , ChunkManagerPtr manager , const BSONObj& query , int broadcastFlag , set<Shard>& shards ) {
+            Shard wroteBack;
+            ChunkManagerPtr sentWith;
+            set<Shard> applied;
+            if ( r.d().reservedField() & DbMessage::Reserved_FromWriteback ) {
+                wroteBack = _writebackShard( r );
+                sentWith = r.getClientInfo()->getWritebackManager();
+                if ( wroteBack.ok() && sentWith ) {
+                    sentWith->getShardsForQuery( applied , query );
+                    applied.erase( wroteBack );
+                }
+            }
+
+            int left = 5;
+            while ( true ) {
+                if ( wroteBack.ok() ) {
+                    if ( ! sentWith ) {
+                        shards.clear();
+                        shards.insert( wroteBack );
+                    }
+                    for ( set<Shard>::const_iterator i=applied.begin(); i!=applied.end(); ++i )
+                        shards.erase( *i );
+
+                    if ( shards.empty() ) {
+                        LOG(1) << "replayed " << opToString( op ) << " already applied everywhere, ns: " << r.getns() << endl;
+                        return;
+                    }
+                }
+
+                set<Shard> all;
+                manager->getAllShards( all );
+
+                if ( shards.size() >= all.size() ) {
+                    LOG(2) << "broadcasting " << opToString( op ) << " to " << shards.size() << " shards, ns: " << r.getns() << endl;
+                    int * x = (int*)(r.d().afterNS());
+                    x[0] |= broadcastFlag;
+                    for ( set<Shard>::iterator i=shards.begin(); i!=shards.end(); i++) {
+                        doWrite( op , r , *i , false );
+                    }
+                    return;
+                }
+
+                vector< shared_ptr<ShardConnection> > conns;
+                bool stale = false;
+                try {
+                    for ( set<Shard>::iterator i=shards.begin(); i!=shards.end() && ! stale; i++) {
+                        shared_ptr<ShardConnection> conn( new ShardConnection( *i , r.getns() ) );
+                        conns.push_back( conn );
+                        stale = conn->setVersion();
+                    }
+                }
+                catch ( StaleConfigException& e ) {
+                    LOG(1) << "targeted " << opToString( op ) << " got " << e << endl;
+                    stale = true;
+                }
+
+                if ( ! stale ) {
+                    LOG(2) << opToString( op ) << " targeted " << shards.size() << " of " << all.size() << " shards, ns: " << r.getns() << endl;
+                    for ( unsigned i=0; i<conns.size(); i++ ) {
+                        (*conns[i])->say( r.m() );
+                        conns[i]->done();
+                    }
+                    return;
+                }
+
+                for ( unsigned i=0; i<conns.size(); i++ )
+                    conns[i]->done();
+
+                if ( left <= 0 )
+                    throw RecvStaleConfigException( r.getns() , "multiWrite" , true );
+                left--;
+                log() << opToString( op ) << " will be retried b/c sharding config info is stale, "
+                      << " left:" << left << " ns: " << r.getns() << " query: " << query << endl;
+                r.reset( false );
+                manager = r.getChunkManager();
+                uassert( 15955 , "collection no longer sharded" , manager );
+                shards.clear();
+                manager->getShardsForQuery( shards , query );
+            }
+        }
+
+        /** @return the shard a replayed writeback came from, or an unset Shard if that isn't known */
+        static Shard _writebackShard( Request& r ) {
+            const string& host = r.getClientInfo()->getWritebackHost();
+            if ( host.empty() )
+                return Shard();
+
+            vector<Shard> all;
+            Shard::getAllShards( all );
+            for ( unsigned i=0; i<all.size(); i++ ) {
+                if ( all[i].containsNode( host ) )
+                    return all[i];
+            }
+
+            warning() << "writeback from " << host << " which isn't a shard, ns: " << r.getns() << endl;
+            return Shard();
+        }
+
         void _update( Request& r , DbMessage& d, ChunkManagerPtr manager ) {
             int flags = d.pullInt();
 
@@ -267,11 +396,7 @@ namespace mongo {
             if ( multi ) {
                 set<Shard> shards;
                 manager->getShardsForQuery( shards , chunkFinder );
-                int * x = (int*)(r.d().afterNS());
-                x[0] |= UpdateOption_Broadcast;
-                for ( set<Shard>::iterator i=shards.begin(); i!=shards.end(); i++) {
-                    doWrite( dbUpdate , r , *i , false );
-                }
+                _multiWrite( dbUpdate , r , manager , chunkFinder , UpdateOption_Broadcast , shards );
             }
             else {
                 int left = 5;
@@ -335,11 +460,7 @@ namespace mongo {
             if ( justOne && ! pattern.hasField( "_id" ) )
                 throw UserException( 8015 , "can only delete with a non-shard key pattern if can delete as many as we find" );
 
-            for ( set<Shard>::iterator i=shards.begin(); i!=shards.end(); i++) {
-                int * x = (int*)(r.d().afterNS());
-                x[0] |= RemoveOption_Broadcast;
-                doWrite( dbDelete , r , *i , false );
-            }
+            _multiWrite( dbDelete , r , manager , pattern , RemoveOption_Broadcast , shards );
         }
 
         virtual void writeOp( int op , Request& r ) {
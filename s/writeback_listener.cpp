@@ -174,12 +174,16 @@ namespace mongo {
 
                     LOG(1) << m.toString() << endl;
 
+                    // the manager the write was routed with, unless we reloaded since
+                    ChunkManagerPtr sentWith;
+
                     if ( needVersion.isSet() && manager && needVersion <= manager->getVersion() ) {
                         // this means when the write went originally, the version was old
                         // if we're here, it means we've already updated the config, so don't need to do again
                         //db->getChunkManager( ns , true ); // SERVER-1349
                     }
                     else {
+                        sentWith = manager;
                         // we received a writeback object that was sent to a previous version of a shard
                         // the actual shard may not have the object the writeback operation is for
                         // we need to reload the chunk manager and get the new shard versions
@@ -191,6 +195,7 @@ namespace mongo {
 
                     BSONObj gle;
                     int attempts = 0;
+                    ClientInfo::get()->setWriteback( _addr , sentWith );
                     while ( true ) {
                         attempts++;
 
@@ -238,6 +243,7 @@ namespace mongo {
                         
                         break;
                     }
+                    ClientInfo::get()->setWriteback( "" , ChunkManagerPtr() );
 
                     {
                         scoped_lock lk( _seenWritebacksLock );
@@ -166,6 +166,19 @@ namespace mongo {
     }
 
 
+    /** receive acknowledgements of pipelined writes until at most max are outstanding */
+    static void _benchRecvAcks( BenchRunConfig * config, const BSONElement& e, DBClientConnection * c, unsigned max ) {
+        while ( c->pendingAcks() > max ) {
+            BSONObj result = c->recvAck();
+
+            if( ! config->hideResults || e["showResult"].trueValue() ) log() << "Result from benchRun thread [acked insert] : " << result << endl;
+
+            if( ! result["err"].eoo() && result["err"].type() == String && ( config->throwGLE || e["throwGLE"].trueValue() ) )
+                throw DBException( (string)"From benchRun GLE" + causedBy( result["err"].String() ),
+                                   result["code"].eoo() ? 0 : result["code"].Int() );
+        }
+    }
+
     static void _benchThread( BenchRunConfig * config, ScopedDbConnection& conn ){
 
         long long count = 0;
@@ -179,6 +192,10 @@ namespace mongo {
 
                 int delay = e["delay"].eoo() ? 0 : e["delay"].Int();
 
+                // insert only: # of acknowledged inserts to keep in flight, see DBClientConnection::sayAcked()
+                int pipeline = op == "insert" ? e["pipeline"].numberInt() : 0;
+                DBClientConnection * ackConn = dynamic_cast< DBClientConnection* >( conn.get() );
+
                 auto_ptr<Scope> scope;
                 ScriptingFunction scopeFunc = 0;
                 BSONObj scopeObj;
@@ -207,6 +224,9 @@ namespace mongo {
                 }
 
                 try {
+                    if ( ackConn && ackConn->pendingAcks() && pipeline <= 0 )
+                        _benchRecvAcks( config, e, ackConn, 0 );
+
                     if ( op == "findOne" ) {
 
                         BSONObj result = conn->findOne( ns , fixQuery( e["query"].Obj() ) );
@@ -291,6 +311,13 @@ namespace mongo {
                                                    result["code"].eoo() ? 0 : result["code"].Int() );
                         }
                     }
+                    else if( op == "insert" && pipeline > 0 ) {
+
+                        uassert( 15940, "benchRun insert pipeline needs a direct connection to the server", ackConn );
+                        BSONObj writeConcern = e["writeConcern"].eoo() ? BSONObj() : e["writeConcern"].Obj();
+                        ackConn->insertAcked( ns, fixQuery( e["doc"].Obj() ), writeConcern );
+                        _benchRecvAcks( config, e, ackConn, pipeline - 1 );
+                    }
                     else if( op == "insert" ) {
 
                         conn->insert( ns, fixQuery( e["doc"].Obj() ) );
@@ -418,9 +445,29 @@ namespace mongo {
         catch( ... ){
             error() << "Exception not handled in benchRun thread." << endl;
         }
-        conn->getLastError();
+        bool connOk = true;
+        try {
+            // the acks of the last pipelined inserts, then wait for the writes
+            DBClientConnection * ackConn = dynamic_cast< DBClientConnection* >( conn.get() );
+            while ( ackConn && ackConn->pendingAcks() )
+                ackConn->recvAck();
+            conn->getLastError();
+        }
+        catch( DBException& e ){
+            error() << "benchRun thread couldn't finish its writes" << causedBy( e ) << endl;
+            connOk = false;
+        }
+        catch( std::exception& e ){
+            error() << "benchRun thread couldn't finish its writes" << causedBy( e ) << endl;
+            connOk = false;
+        }
         config->threadsActive--;
-        conn.done();
+
+        // a connection with acks still unread can't go back to the pool
+        if ( connOk )
+            conn.done();
+        else
+            conn.kill();
 
     }
 
@@ -57,7 +57,7 @@ namespace mongo {
     }
 
     bool doesOpGetAResponse( int op ) {
-        return op == dbQuery || op == dbGetMore;
+        return op == dbQuery || op == dbGetMore || op == dbWriteAck;
     }
 
 
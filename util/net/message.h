@@ -38,7 +38,8 @@ namespace mongo {
         dbQuery = 2004,
         dbGetMore = 2005,
         dbDelete = 2006,
-        dbKillCursors = 2007
+        dbKillCursors = 2007,
+        dbWriteAck = 2008 /* an insert, update or delete the server replies to with its getLastError result */
     };
 
     bool doesOpGetAResponse( int op );
@@ -54,6 +55,7 @@ namespace mongo {
         case dbGetMore: return "getmore";
         case dbDelete: return "remove";
         case dbKillCursors: return "killcursors";
+        case dbWriteAck: return "writeack";
         default:
             PRINT(op);
             assert(0);
@@ -75,6 +77,7 @@ namespace mongo {
         case dbUpdate:
         case dbInsert:
         case dbDelete:
+        case dbWriteAck:
             return false;
 
         default:
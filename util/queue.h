@@ -20,22 +20,51 @@
 #include "../pch.h"
 
 #include <queue>
+#include <limits>
 
 #include "../util/timer.h"
 
 namespace mongo {
 
+    template<typename T>
+    size_t _getSizeDefault(const T& t) {
+        return 1;
+    }
+
     /**
      * simple blocking queue
+     *
+     * optionally bounded: push() blocks while adding an element would take the
+     * sum of getSize() over the queued elements past maxSize.  an element is
+     * always accepted by an empty queue, even if it is larger than maxSize.
      */
     template<typename T> class BlockingQueue : boost::noncopyable {
+        typedef size_t (*getSizeFunc)(const T& t);
     public:
-        BlockingQueue() : _lock("BlockingQueue") { }
+        BlockingQueue() :
+            _lock("BlockingQueue"),
+            _maxSize(std::numeric_limits<std::size_t>::max()),
+            _currentSize(0),
+            _getSize(&_getSizeDefault) {}
+        BlockingQueue(size_t size) :
+            _lock("BlockingQueue(bounded)"),
+            _maxSize(size),
+            _currentSize(0),
+            _getSize(&_getSizeDefault) {}
+        BlockingQueue(size_t size, getSizeFunc f) :
+            _lock("BlockingQueue(custom size)"),
+            _maxSize(size),
+            _currentSize(0),
+            _getSize(f) {}
 
         void push(T const& t) {
             scoped_lock l( _lock );
+            size_t tSize = _getSize(t);
+            while ( !_queue.empty() && _currentSize + tSize > _maxSize )
+                _cvNoLongerFull.wait( l.boost() );
             _queue.push( t );
-            _condition.notify_one();
+            _currentSize += tSize;
+            _cvNoLongerEmpty.notify_one();
         }
 
         bool empty() const {
@@ -43,20 +72,26 @@ namespace mongo {
             return _queue.empty();
         }
 
+        /** @return number of queued elements */
         size_t size() const {
             scoped_lock l( _lock );
             return _queue.size();
         }
 
+        /** @return sum of getSize() over the queued elements */
+        size_t currentSize() const {
+            scoped_lock l( _lock );
+            return _currentSize;
+        }
+
+        size_t maxSize() const { return _maxSize; }
 
         bool tryPop( T & t ) {
             scoped_lock l( _lock );
             if ( _queue.empty() )
                 return false;
 
-            t = _queue.front();
-            _queue.pop();
-
+            _pop( t );
             return true;
         }
 
@@ -64,10 +99,10 @@ namespace mongo {
 
             scoped_lock l( _lock );
             while( _queue.empty() )
-                _condition.wait( l.boost() );
+                _cvNoLongerEmpty.wait( l.boost() );
 
-            T t = _queue.front();
-            _queue.pop();
+            T t;
+            _pop( t );
             return t;
         }
 
@@ -87,20 +122,31 @@ namespace mongo {
 
             scoped_lock l( _lock );
             while( _queue.empty() ) {
-                if ( ! _condition.timed_wait( l.boost() , xt ) )
+                if ( ! _cvNoLongerEmpty.timed_wait( l.boost() , xt ) )
                     return false;
             }
 
-            t = _queue.front();
-            _queue.pop();
+            _pop( t );
             return true;
         }
 
     private:
+        void _pop( T& t ) {
+            t = _queue.front();
+            _queue.pop();
+            _currentSize -= _getSize( t );
+            _cvNoLongerFull.notify_one();
+        }
+
         std::queue<T> _queue;
 
         mutable mongo::mutex _lock;
-        boost::condition _condition;
+        const size_t _maxSize;
+        size_t _currentSize;
+        getSizeFunc _getSize;
+
+        boost::condition _cvNoLongerFull;
+        boost::condition _cvNoLongerEmpty;
     };
 
 }